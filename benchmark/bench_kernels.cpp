@@ -0,0 +1,409 @@
+/*******************************************************************************
+ * benchmark/bench_kernels.cpp
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <set>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <tlx/cmdline_parser.hpp>
+#include <tlx/logger.hpp>
+
+#include "io.hpp"
+#include "lce_naive.hpp"
+#include "lce_prezza.hpp"
+#include "text_generator.hpp"
+#include "timer.hpp"
+#include "util/perf_counters.hpp"
+#include "util/successor/index.hpp"
+#include "util_ssss_par/par_rmq_n.hpp"
+#include "util_ssss_par/ring_buffer.hpp"
+#include "util_ssss_par/rk_prime.hpp"
+#include "util_ssss_par/ssss_par.hpp"
+#include "util_ssss_par/string_sort_helper.hpp"
+
+/* Microbenchmarks of the inner kernels of the LCE data structures. Every
+ * kernel runs on one thread over inputs that are prepared before the time is
+ * taken (random positions, pairs, or ranges), so that an optimization of a
+ * kernel can be checked without the noise of whole constructions or query
+ * runs. The text is a file or a generator spec (gen:<spec>, see
+ * text_generator.hpp), and --distance turns the random LCE pairs into pairs
+ * (i, i + distance), which controls the LCEs on periodic texts.
+ *
+ * Each kernel prints a RESULT line with ns_per_op (of the fastest run),
+ * ns_per_op_avg, bytes_per_op (the input that one operation covers:
+ * characters rolled or compared, the bytes of a block, an RMQ range, a key,
+ * or a buffer element), and a checksum of the results, which must not change
+ * with an optimization. */
+class kernel_benchmark {
+ public:
+  // The tau of the string synchronizing sets, as in s1024
+  static constexpr size_t kTau = 1024;
+
+  std::string text_spec = "gen:uniform:n=16Mi,sigma=4";
+  std::string kernels;
+  size_t prefix_length = 0;
+  size_t ops = size_t{4} << 20;
+  size_t runs = 5;
+  size_t seed = 1;
+  size_t distance = 0;
+  bool perf = false;
+
+  static constexpr char const* kKernels[] = {
+      "rk_roll", "naive_lce", "prezza_block", "prezza_fingerprint", "rmq",
+      "successor", "ring_push", "ring_window", "sss_compare"};
+
+  void run() {
+    std::set<std::string> selected;
+    std::istringstream in(kernels);
+    for (std::string k; std::getline(in, k, ',');) {
+      if (std::find(std::begin(kKernels), std::end(kKernels), k) == std::end(kKernels)) {
+        std::cerr << "Unknown kernel " << k << std::endl;
+        std::exit(EXIT_FAILURE);
+      }
+      selected.insert(k);
+    }
+    auto const wanted = [&](std::string const& k) {
+      return selected.empty() || selected.contains(k);
+    };
+
+    if (text_spec.starts_with("gen:")) {
+      text_ = textgen::generate(text_spec.substr(4));
+    } else {
+      text_ = load_text(text_spec, prefix_length);
+    }
+    n_ = text_.size();
+    // The comparisons of sss_compare may read up to 3 * tau characters
+    // behind the end of the text.
+    text_.resize(n_ + 3 * kTau, 0);
+    if (n_ <= 4 * kTau) {
+      std::cerr << "The text must be longer than " << 4 * kTau << " characters" << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+    if (distance >= n_ - 1) {
+      std::cerr << "The distance must be less than " << n_ - 1 << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+    gen_.seed(seed);
+
+    if (wanted("rk_roll")) { rk_roll(); }
+    if (wanted("naive_lce")) { naive_lce(); }
+    if (wanted("prezza_block") || wanted("prezza_fingerprint")) {
+      prezza(wanted("prezza_block"), wanted("prezza_fingerprint"));
+    }
+    if (wanted("rmq")) { rmq(); }
+    if (wanted("ring_push")) { ring_push(); }
+    if (wanted("ring_window")) { ring_window(); }
+    if (wanted("successor") || wanted("sss_compare")) {
+      string_synchronizing_set_par<kTau, uint32_t> const sss(text());
+      if (sss.size() < 2) {
+        std::cerr << "The synchronizing set has less than two positions" << std::endl;
+      } else {
+        if (wanted("successor")) { successor(sss); }
+        if (wanted("sss_compare")) { sss_compare(sss); }
+      }
+    }
+  }
+
+ private:
+  __extension__ typedef unsigned __int128 uint128_t;
+
+  struct kernel_result {
+    uint64_t checksum = 0;
+    // The input that the operations covered
+    uint64_t bytes = 0;
+  };
+
+  std::vector<uint8_t> text_;
+  size_t n_ = 0;
+  std::mt19937_64 gen_;
+
+  std::span<uint8_t const> text() const {
+    return {text_.data(), n_};
+  }
+
+  std::vector<uint64_t> random_positions(size_t const count, uint64_t const max) {
+    std::uniform_int_distribution<uint64_t> pos(0, max);
+    std::vector<uint64_t> result(count);
+    for (auto& p : result) {
+      p = pos(gen_);
+    }
+    return result;
+  }
+
+  /* Runs kernel, which performs num_ops operations, runs times and prints
+     the RESULT line. */
+  template <typename Kernel>
+  void measure(std::string const& name, std::string const& param, size_t const num_ops,
+               Kernel&& kernel) {
+    lce_test::perf_counters const counters(perf);
+    lce_test::perf_sample const perf_begin = counters.read();
+    kernel_result result;
+    size_t min_ns = std::numeric_limits<size_t>::max();
+    size_t sum_ns = 0;
+    for (size_t r = 0; r < runs; ++r) {
+      timer t;
+      result = kernel();
+      size_t const ns = t.get_ns();
+      min_ns = std::min(min_ns, ns);
+      sum_ns += ns;
+    }
+    lce_test::perf_sample const perf_all = counters.read() - perf_begin;
+
+    double const ops_d = std::max<double>(num_ops, 1);
+    std::cout << "RESULT kernel=" << name << " "
+              << "param=" << (param.empty() ? "none" : param) << " "
+              << "text=" << text_spec << " "
+              << "size=" << n_ << " "
+              << "ops=" << num_ops << " "
+              << "runs=" << runs << " "
+              << "ns_per_op=" << min_ns / ops_d << " "
+              << "ns_per_op_avg=" << sum_ns / (ops_d * runs) << " "
+              << "bytes_per_op=" << result.bytes / ops_d << " "
+              << "checksum=" << result.checksum;
+    if (counters.available()) {
+      std::cout << " ";
+      perf_all.print(std::cout, "op_", ops_d * runs);
+    }
+    std::cout << std::endl;
+  }
+
+  /* The rolling hash of the string synchronizing sets over the text from
+     its start. The copy of the prepared hash (with a table of 1 MiB) is
+     negligible against the rolls. */
+  void rk_roll() {
+    using rk_type = herlez::rolling_hash::rk_prime<uint8_t const*, 107>;
+    size_t const num_ops = std::min(ops, n_ - kTau - 1);
+    auto const prepared = std::make_unique<rk_type>(text_.data(), kTau, 296813);
+    measure("rk_roll", "tau=" + std::to_string(kTau), num_ops, [&]() {
+      auto rk = std::make_unique<rk_type>(*prepared);
+      kernel_result result;
+      for (size_t i = 0; i < num_ops; ++i) {
+        result.checksum += static_cast<uint64_t>(rk->roll());
+      }
+      result.bytes = num_ops;
+      return result;
+    });
+  }
+
+  /* The naive scan (8 characters, then 16 byte blocks) of LceNaive for
+     random pairs or pairs at the given distance */
+  void naive_lce() {
+    LceNaive lce(text());
+    std::vector<uint64_t> const i = random_positions(ops, n_ - 1 - distance);
+    std::vector<uint64_t> j = random_positions(ops, n_ - 1);
+    if (distance > 0) {
+      for (size_t q = 0; q < ops; ++q) {
+        j[q] = i[q] + distance;
+      }
+    }
+    measure("naive_lce", "distance=" + std::to_string(distance), ops, [&]() {
+      kernel_result result;
+      for (size_t q = 0; q < ops; ++q) {
+        uint64_t const l = lce.lce(i[q], j[q]);
+        result.checksum += l;
+        result.bytes += l + 1;
+      }
+      return result;
+    });
+  }
+
+  /* Decoding a block and the fingerprint of a prefix from the fingerprints
+     that replace the text in LcePrezza */
+  void prezza(bool const block, bool const fingerprint) {
+    // The data structure overwrites the text, and queries may read the
+    // block after the last one.
+    std::vector<uint64_t> blocks((n_ + 7) / 8 + 1, 0);
+    std::memcpy(blocks.data(), text_.data(), n_);
+    LcePrezza<128> const lce(blocks.data(), n_);
+    if (block) {
+      std::vector<uint64_t> const b = random_positions(ops, (n_ - 1) / 8);
+      measure("prezza_block", "", ops, [&]() {
+        kernel_result result;
+        for (uint64_t const q : b) {
+          result.checksum += lce.getBlock(q);
+        }
+        result.bytes = 8 * ops;
+        return result;
+      });
+    }
+    if (fingerprint) {
+      std::vector<uint64_t> const i = random_positions(ops, n_ - 1);
+      measure("prezza_fingerprint", "", ops, [&]() {
+        kernel_result result;
+        for (uint64_t const q : i) {
+          result.checksum += lce.fingerprintTo(q);
+        }
+        result.bytes = 8 * ops;
+        return result;
+      });
+    }
+  }
+
+  /* RMQs of par_RMQ_n over random 32 bit values (as many as the text has
+     characters), for ranges of 16, 256, ..., 2^20 values */
+  void rmq() {
+    std::uniform_int_distribution<uint32_t> value;
+    std::vector<uint32_t> values(n_);
+    for (auto& v : values) {
+      v = value(gen_);
+    }
+    lce_test::serialization::array<uint32_t> const keys(std::move(values));
+    lce_test::par::par_RMQ_n<uint32_t> const rmq(keys);
+    for (size_t length = 16; length <= std::min<size_t>(n_, size_t{1} << 20); length *= 16) {
+      std::vector<uint64_t> const left = random_positions(ops, n_ - length);
+      measure("rmq", "range=" + std::to_string(length), ops, [&]() {
+        kernel_result result;
+        for (uint64_t const l : left) {
+          result.checksum += rmq.rmq(l, l + length - 1);
+        }
+        result.bytes = ops * length * sizeof(uint32_t);
+        return result;
+      });
+    }
+  }
+
+  /* Successor queries of the index over the synchronizing positions, for
+     random positions of the text */
+  void successor(string_synchronizing_set_par<kTau, uint32_t> const& sss) {
+    std::vector<uint32_t> const positions(sss.get_sss().begin(), sss.get_sss().end());
+    stash::pred::index<std::vector<uint32_t>, uint32_t, 7> const index(positions);
+    std::vector<uint64_t> const i = random_positions(ops, n_ - 1);
+    measure("successor", "keys=" + std::to_string(positions.size()), ops, [&]() {
+      kernel_result result;
+      for (uint64_t const q : i) {
+        stash::pred::result const r = index.successor(q);
+        result.checksum += r.exists ? r.pos : 0;
+      }
+      result.bytes = ops * sizeof(uint32_t);
+      return result;
+    });
+  }
+
+  /* Appending fingerprints to the ring buffer of the construction of the
+     string synchronizing sets */
+  void ring_push() {
+    measure("ring_push", "capacity=" + std::to_string(4 * kTau), ops, [&]() {
+      ring_buffer<uint128_t> buffer(4 * kTau);
+      kernel_result result;
+      for (size_t i = 0; i < ops; ++i) {
+        buffer.push_back(uint128_t{i} * 0x9E3779B97F4A7C15ULL);
+      }
+      for (size_t i = buffer.size() - 4 * kTau; i < buffer.size(); ++i) {
+        result.checksum += static_cast<uint64_t>(buffer[i]);
+      }
+      result.bytes = ops * sizeof(uint128_t);
+      return result;
+    });
+  }
+
+  /* The search for the minimum of tau + 1 fingerprints in the ring buffer,
+     as in fill_synchronizing_set(). An operation is one fingerprint. */
+  void ring_window() {
+    ring_buffer<uint128_t> buffer(4 * kTau);
+    std::uniform_int_distribution<uint64_t> fingerprint;
+    for (size_t i = 0; i < 4 * kTau; ++i) {
+      buffer.push_back((uint128_t{fingerprint(gen_)} << 64) | fingerprint(gen_));
+    }
+    size_t const windows = std::max<size_t>(1, ops / (kTau + 1));
+    size_t const num_ops = windows * (kTau + 1);
+    std::vector<uint64_t> const begin = random_positions(windows, 3 * kTau - 1);
+    measure("ring_window", "tau=" + std::to_string(kTau), num_ops, [&]() {
+      kernel_result result;
+      for (uint64_t const b : begin) {
+        uint64_t min = b;
+        for (uint64_t j = b; j <= b + kTau; ++j) {
+          if (buffer[j] < buffer[min]) {
+            min = j;
+          }
+        }
+        result.checksum += min;
+      }
+      result.bytes = num_ops * sizeof(uint128_t);
+      return result;
+    });
+  }
+
+  /* The comparison of two 3 * tau long strings at random synchronizing
+     positions by the string set of the string sorter (including the order
+     of runs), as in check_order() */
+  void sss_compare(string_synchronizing_set_par<kTau, uint32_t> const& sss) {
+    using string_set = lce_test::par::StringShortSuffixSet<3 * kTau, uint32_t>;
+    std::vector<uint32_t> positions(sss.get_sss().begin(), sss.get_sss().end());
+    lce_test::par::mock_string const text_str(text_.data(), n_);
+    string_set const set(text_str, positions.begin(), positions.end(), sss);
+    std::vector<uint64_t> const a = random_positions(ops, positions.size() - 1);
+    std::vector<uint64_t> const b = random_positions(ops, positions.size() - 1);
+    measure("sss_compare", "tau=" + std::to_string(kTau), ops, [&]() {
+      kernel_result result;
+      for (size_t q = 0; q < ops; ++q) {
+        uint32_t const s = positions[a[q]];
+        uint32_t const t = positions[b[q]];
+        if (s == t) {
+          continue;
+        }
+        string_set::CharIterator si = set.get_chars(s, 0);
+        string_set::CharIterator ti = set.get_chars(t, 0);
+        while (set.is_equal(s, si, t, ti)) {
+          ++si;
+          ++ti;
+        }
+        uint64_t const depth = si - set.get_chars(s, 0);
+        result.checksum += depth + set.is_less(s, si, t, ti);
+        result.bytes += depth + 1;
+      }
+      return result;
+    });
+  }
+};
+
+int32_t main(int32_t argc, char *argv[]) {
+  kernel_benchmark bench;
+
+  tlx::CmdlineParser cp;
+  cp.set_description("This program measures the inner kernels of the LCE data "
+                     "structures in isolation, on one thread: rk_roll, "
+                     "naive_lce, prezza_block, prezza_fingerprint, rmq, "
+                     "successor, ring_push, ring_window, and sss_compare. It "
+                     "reports ns/op, bytes/op, and a checksum per kernel.");
+  cp.add_opt_param_string("text", bench.text_spec, "Path to the text or gen:<spec> "
+                          "for a synthetic text (default: "
+                          "gen:uniform:n=16Mi,sigma=4, see gentext).");
+  cp.add_string('k', "kernels", bench.kernels, "Comma separated kernels to "
+                "measure (default: all).");
+  cp.add_bytes('p', "pre", bench.prefix_length, "Size of the prefix of the "
+               "text file in bytes that is used.");
+  cp.add_bytes('q', "ops", bench.ops, "Number of operations per run "
+               "(default: 4Mi).");
+  cp.add_size_t('r', "runs", bench.runs, "Number of runs of every kernel "
+                "(default: 5).");
+  cp.add_size_t("seed", bench.seed, "Seed of the random inputs (default: 1).");
+  cp.add_bytes('d', "distance", bench.distance, "Compare the positions i and "
+               "i + distance in naive_lce instead of random pairs.");
+  cp.add_flag("perf", bench.perf, "Count cycles, instructions, cache, TLB and "
+              "branch misses per operation with hardware performance "
+              "counters, if they are available.");
+
+  if (!cp.process(argc, argv)) {
+    std::exit(EXIT_FAILURE);
+  }
+  if (bench.runs == 0) {
+    bench.runs = 1;
+  }
+  bench.run();
+  return 0;
+}
+
+/******************************************************************************/
@@ -18,6 +18,7 @@
 
 #include <malloc_count.h>
 
+#include "util/perf_counters.hpp"
 #include "util/successor/binsearch.hpp"
 #include "util/successor/binsearch_cache.hpp"
 #include "util/successor/index.hpp"
@@ -94,17 +95,23 @@ struct test_result {
     size_t   m_ds;
     uint64_t t_queries;
     uint64_t sum;
+    lce_test::perf_sample perf_construct;
+    lce_test::perf_sample perf_queries;
 };
 
 template<typename pred_t>
 test_result test_predecessor(
     const std::vector<value_t>& array,
-    const std::vector<value_t>& queries) {
+    const std::vector<value_t>& queries,
+    const lce_test::perf_counters& perf) {
 
     // construct
+    lce_test::perf_sample perf_construct;
     auto t0 = time();
     auto m0 = malloc_count_current();
+    lce_test::perf_counters::phase construct_phase(perf, perf_construct);
     pred_t q(array);
+    construct_phase.stop();
     uint64_t t_construct = time() - t0;
     size_t   m_ds = malloc_count_current() - m0;
 
@@ -112,8 +119,10 @@ test_result test_predecessor(
     const auto min = array[0];
     uint64_t t_queries;
     uint64_t sum = 0;
+    lce_test::perf_sample perf_queries;
     {
         auto t0 = time();
+        lce_test::perf_counters::phase queries_phase(perf, perf_queries);
         for(value_t x : queries) {
             auto r = q.predecessor(x);
 
@@ -125,21 +134,26 @@ test_result test_predecessor(
                 assert(!r.exists);
             }
         }
+        queries_phase.stop();
         t_queries = time() - t0;
     }
 
-    return test_result { 0, t_construct, m_ds, t_queries, sum };
+    return test_result { 0, t_construct, m_ds, t_queries, sum, perf_construct, perf_queries };
 }
 
 template<typename pred_t>
 test_result test_successor(
     const std::vector<value_t>& array,
-    const std::vector<value_t>& queries) {
+    const std::vector<value_t>& queries,
+    const lce_test::perf_counters& perf) {
 
     // construct
+    lce_test::perf_sample perf_construct;
     auto t0 = time();
     auto m0 = malloc_count_current();
+    lce_test::perf_counters::phase construct_phase(perf, perf_construct);
     pred_t q(array);
+    construct_phase.stop();
     uint64_t t_construct = time() - t0;
     size_t   m_ds = malloc_count_current() - m0;
 
@@ -147,8 +161,10 @@ test_result test_successor(
     const auto max = array[array.size()-1ULL];
     uint64_t t_queries;
     uint64_t sum = 0;
+    lce_test::perf_sample perf_queries;
     {
         auto t0 = time();
+        lce_test::perf_counters::phase queries_phase(perf, perf_queries);
         for(value_t x : queries) {
             auto r = q.successor(x);
             if(x <= max) {
@@ -159,10 +175,11 @@ test_result test_successor(
                 assert(!r.exists);
             }
         }
+        queries_phase.stop();
         t_queries = time() - t0;
     }
 
-    return test_result { 1, t_construct, m_ds, t_queries, sum };
+    return test_result { 1, t_construct, m_ds, t_queries, sum, perf_construct, perf_queries };
 }
 
 int main(int argc, char** argv) {
@@ -186,9 +203,16 @@ int main(int argc, char** argv) {
     bool no_succ = false;
     cp.add_bool("no-succ", no_succ, "Don't do successor benchmark.");
 
+    bool perf = false;
+    cp.add_flag("perf", perf, "Count cycles, instructions, cache, TLB and branch misses with hardware performance counters, if they are available.");
+
     if (!cp.process(argc, argv)) {
         return -1;
     }
+    lce_test::perf_counters const counters(perf);
+    if (perf && !counters.available()) {
+        std::cout << "# hardware performance counters are not available" << std::endl;
+    }
     
     #ifdef ALLOW_PARALLEL
     std::cout << "# benchmarking PARALLEL construction" << std::endl;
@@ -225,7 +249,10 @@ int main(int argc, char** argv) {
             << " t_construct=" << r.t_construct
             << " t_queries=" << r.t_queries
             << " m_ds=" << r.m_ds
-            << " sum=" << r.sum << std::endl;
+            << " sum=" << r.sum << " ";
+        r.perf_construct.print(std::cout, "construct_");
+        r.perf_queries.print(std::cout, "query_", std::max<double>(1, queries.size()));
+        std::cout << std::endl;
     };
 
     // run tests
@@ -233,107 +260,107 @@ int main(int argc, char** argv) {
     std::cout << "# predecessor ..." << std::endl;
     
     #ifdef ALLOW_PARALLEL
-    print_result("idx<4>", test_predecessor<index_par<4>>(array, queries));
-    print_result("idx<5>", test_predecessor<index_par<5>>(array, queries));
-    print_result("idx<6>", test_predecessor<index_par<6>>(array, queries));
-    print_result("idx<7>", test_predecessor<index_par<7>>(array, queries));
-    print_result("idx<8>", test_predecessor<index_par<8>>(array, queries));
-    print_result("idx<9>", test_predecessor<index_par<9>>(array, queries));
-    print_result("idx<10>", test_predecessor<index_par<10>>(array, queries));
-    print_result("idx<11>", test_predecessor<index_par<11>>(array, queries));
-    print_result("idx<12>", test_predecessor<index_par<12>>(array, queries));
-    print_result("idx<13>", test_predecessor<index_par<13>>(array, queries));
-    print_result("idx<14>", test_predecessor<index_par<14>>(array, queries));
-    print_result("idx<15>", test_predecessor<index_par<15>>(array, queries));
-    print_result("idx<16>", test_predecessor<index_par<16>>(array, queries));
+    print_result("idx<4>", test_predecessor<index_par<4>>(array, queries, counters));
+    print_result("idx<5>", test_predecessor<index_par<5>>(array, queries, counters));
+    print_result("idx<6>", test_predecessor<index_par<6>>(array, queries, counters));
+    print_result("idx<7>", test_predecessor<index_par<7>>(array, queries, counters));
+    print_result("idx<8>", test_predecessor<index_par<8>>(array, queries, counters));
+    print_result("idx<9>", test_predecessor<index_par<9>>(array, queries, counters));
+    print_result("idx<10>", test_predecessor<index_par<10>>(array, queries, counters));
+    print_result("idx<11>", test_predecessor<index_par<11>>(array, queries, counters));
+    print_result("idx<12>", test_predecessor<index_par<12>>(array, queries, counters));
+    print_result("idx<13>", test_predecessor<index_par<13>>(array, queries, counters));
+    print_result("idx<14>", test_predecessor<index_par<14>>(array, queries, counters));
+    print_result("idx<15>", test_predecessor<index_par<15>>(array, queries, counters));
+    print_result("idx<16>", test_predecessor<index_par<16>>(array, queries, counters));
     #else
-    print_result("bs", test_predecessor<binsearch>(array, queries));
-    print_result("bs*", test_predecessor<binsearch_cache>(array, queries));
-    print_result("bs_std", test_predecessor<binsearch_std>(array, queries));
-    print_result("rank", test_predecessor<rank>(array, queries));
-    print_result("idx<4>", test_predecessor<index<4>>(array, queries));
-    print_result("idx<5>", test_predecessor<index<5>>(array, queries));
-    print_result("idx<6>", test_predecessor<index<6>>(array, queries));
-    print_result("idx<7>", test_predecessor<index<7>>(array, queries));
-    print_result("idx<8>", test_predecessor<index<8>>(array, queries));
-    print_result("idx<9>", test_predecessor<index<9>>(array, queries));
-    print_result("idx<10>", test_predecessor<index<10>>(array, queries));
-    print_result("idx<11>", test_predecessor<index<11>>(array, queries));
-    print_result("idx<12>", test_predecessor<index<12>>(array, queries));
-    print_result("idx<13>", test_predecessor<index<13>>(array, queries));
-    print_result("idx<14>", test_predecessor<index<14>>(array, queries));
-    print_result("idx<15>", test_predecessor<index<15>>(array, queries));
-    print_result("idx<16>", test_predecessor<index<16>>(array, queries));
+    print_result("bs", test_predecessor<binsearch>(array, queries, counters));
+    print_result("bs*", test_predecessor<binsearch_cache>(array, queries, counters));
+    print_result("bs_std", test_predecessor<binsearch_std>(array, queries, counters));
+    print_result("rank", test_predecessor<rank>(array, queries, counters));
+    print_result("idx<4>", test_predecessor<index<4>>(array, queries, counters));
+    print_result("idx<5>", test_predecessor<index<5>>(array, queries, counters));
+    print_result("idx<6>", test_predecessor<index<6>>(array, queries, counters));
+    print_result("idx<7>", test_predecessor<index<7>>(array, queries, counters));
+    print_result("idx<8>", test_predecessor<index<8>>(array, queries, counters));
+    print_result("idx<9>", test_predecessor<index<9>>(array, queries, counters));
+    print_result("idx<10>", test_predecessor<index<10>>(array, queries, counters));
+    print_result("idx<11>", test_predecessor<index<11>>(array, queries, counters));
+    print_result("idx<12>", test_predecessor<index<12>>(array, queries, counters));
+    print_result("idx<13>", test_predecessor<index<13>>(array, queries, counters));
+    print_result("idx<14>", test_predecessor<index<14>>(array, queries, counters));
+    print_result("idx<15>", test_predecessor<index<15>>(array, queries, counters));
+    print_result("idx<16>", test_predecessor<index<16>>(array, queries, counters));
     #endif
-    print_result("j_index", test_predecessor<j_index>(array, queries));
-    print_result("pgm<4>", test_predecessor<pgm_index<4>>(array, queries));
-    print_result("pgm<8>", test_predecessor<pgm_index<8>>(array, queries));
-    print_result("pgm<12>", test_predecessor<pgm_index<12>>(array, queries));
-    print_result("pgm<16>", test_predecessor<pgm_index<16>>(array, queries));
-    print_result("pgm<20>", test_predecessor<pgm_index<20>>(array, queries));
-    print_result("pgm<24>", test_predecessor<pgm_index<24>>(array, queries));
-    print_result("pgm<32>", test_predecessor<pgm_index<32>>(array, queries));
-    print_result("pgm<48>", test_predecessor<pgm_index<48>>(array, queries));
-    print_result("pgm<64>", test_predecessor<pgm_index<64>>(array, queries));
-    print_result("pgm<80>", test_predecessor<pgm_index<80>>(array, queries));
-    print_result("pgm<96>", test_predecessor<pgm_index<96>>(array, queries));
-    print_result("pgm<112>", test_predecessor<pgm_index<112>>(array, queries));
-    print_result("pgm<128>", test_predecessor<pgm_index<128>>(array, queries));
-    print_result("pgm<256>", test_predecessor<pgm_index<256>>(array, queries));
-    print_result("pgm<512>", test_predecessor<pgm_index<512>>(array, queries));
+    print_result("j_index", test_predecessor<j_index>(array, queries, counters));
+    print_result("pgm<4>", test_predecessor<pgm_index<4>>(array, queries, counters));
+    print_result("pgm<8>", test_predecessor<pgm_index<8>>(array, queries, counters));
+    print_result("pgm<12>", test_predecessor<pgm_index<12>>(array, queries, counters));
+    print_result("pgm<16>", test_predecessor<pgm_index<16>>(array, queries, counters));
+    print_result("pgm<20>", test_predecessor<pgm_index<20>>(array, queries, counters));
+    print_result("pgm<24>", test_predecessor<pgm_index<24>>(array, queries, counters));
+    print_result("pgm<32>", test_predecessor<pgm_index<32>>(array, queries, counters));
+    print_result("pgm<48>", test_predecessor<pgm_index<48>>(array, queries, counters));
+    print_result("pgm<64>", test_predecessor<pgm_index<64>>(array, queries, counters));
+    print_result("pgm<80>", test_predecessor<pgm_index<80>>(array, queries, counters));
+    print_result("pgm<96>", test_predecessor<pgm_index<96>>(array, queries, counters));
+    print_result("pgm<112>", test_predecessor<pgm_index<112>>(array, queries, counters));
+    print_result("pgm<128>", test_predecessor<pgm_index<128>>(array, queries, counters));
+    print_result("pgm<256>", test_predecessor<pgm_index<256>>(array, queries, counters));
+    print_result("pgm<512>", test_predecessor<pgm_index<512>>(array, queries, counters));
     }
 
     if(!no_succ) {
     std::cout << "# successor ..." << std::endl;
     
     #ifdef ALLOW_PARALLEL
-    print_result("idx<4>", test_successor<index_par<4>>(array, queries));
-    print_result("idx<5>", test_successor<index_par<5>>(array, queries));
-    print_result("idx<6>", test_successor<index_par<6>>(array, queries));
-    print_result("idx<7>", test_successor<index_par<7>>(array, queries));
-    print_result("idx<8>", test_successor<index_par<8>>(array, queries));
-    print_result("idx<9>", test_successor<index_par<9>>(array, queries));
-    print_result("idx<10>", test_successor<index_par<10>>(array, queries));
-    print_result("idx<11>", test_successor<index_par<11>>(array, queries));
-    print_result("idx<12>", test_successor<index_par<12>>(array, queries));
-    print_result("idx<13>", test_successor<index_par<13>>(array, queries));
-    print_result("idx<14>", test_successor<index_par<14>>(array, queries));
-    print_result("idx<15>", test_successor<index_par<15>>(array, queries));
-    print_result("idx<16>", test_successor<index_par<16>>(array, queries));
+    print_result("idx<4>", test_successor<index_par<4>>(array, queries, counters));
+    print_result("idx<5>", test_successor<index_par<5>>(array, queries, counters));
+    print_result("idx<6>", test_successor<index_par<6>>(array, queries, counters));
+    print_result("idx<7>", test_successor<index_par<7>>(array, queries, counters));
+    print_result("idx<8>", test_successor<index_par<8>>(array, queries, counters));
+    print_result("idx<9>", test_successor<index_par<9>>(array, queries, counters));
+    print_result("idx<10>", test_successor<index_par<10>>(array, queries, counters));
+    print_result("idx<11>", test_successor<index_par<11>>(array, queries, counters));
+    print_result("idx<12>", test_successor<index_par<12>>(array, queries, counters));
+    print_result("idx<13>", test_successor<index_par<13>>(array, queries, counters));
+    print_result("idx<14>", test_successor<index_par<14>>(array, queries, counters));
+    print_result("idx<15>", test_successor<index_par<15>>(array, queries, counters));
+    print_result("idx<16>", test_successor<index_par<16>>(array, queries, counters));
     #else
-    print_result("bs", test_successor<binsearch>(array, queries));
-    print_result("bs*", test_successor<binsearch_cache>(array, queries));
-    print_result("bs_std", test_successor<binsearch_std>(array, queries));
-    print_result("rank", test_successor<rank>(array, queries));
-    print_result("idx<4>", test_successor<index<4>>(array, queries));
-    print_result("idx<5>", test_successor<index<5>>(array, queries));
-    print_result("idx<6>", test_successor<index<6>>(array, queries));
-    print_result("idx<7>", test_successor<index<7>>(array, queries));
-    print_result("idx<8>", test_successor<index<8>>(array, queries));
-    print_result("idx<9>", test_successor<index<9>>(array, queries));
-    print_result("idx<10>", test_successor<index<10>>(array, queries));
-    print_result("idx<11>", test_successor<index<11>>(array, queries));
-    print_result("idx<12>", test_successor<index<12>>(array, queries));
-    print_result("idx<13>", test_successor<index<13>>(array, queries));
-    print_result("idx<14>", test_successor<index<14>>(array, queries));
-    print_result("idx<15>", test_successor<index<15>>(array, queries));
-    print_result("idx<16>", test_successor<index<16>>(array, queries));
+    print_result("bs", test_successor<binsearch>(array, queries, counters));
+    print_result("bs*", test_successor<binsearch_cache>(array, queries, counters));
+    print_result("bs_std", test_successor<binsearch_std>(array, queries, counters));
+    print_result("rank", test_successor<rank>(array, queries, counters));
+    print_result("idx<4>", test_successor<index<4>>(array, queries, counters));
+    print_result("idx<5>", test_successor<index<5>>(array, queries, counters));
+    print_result("idx<6>", test_successor<index<6>>(array, queries, counters));
+    print_result("idx<7>", test_successor<index<7>>(array, queries, counters));
+    print_result("idx<8>", test_successor<index<8>>(array, queries, counters));
+    print_result("idx<9>", test_successor<index<9>>(array, queries, counters));
+    print_result("idx<10>", test_successor<index<10>>(array, queries, counters));
+    print_result("idx<11>", test_successor<index<11>>(array, queries, counters));
+    print_result("idx<12>", test_successor<index<12>>(array, queries, counters));
+    print_result("idx<13>", test_successor<index<13>>(array, queries, counters));
+    print_result("idx<14>", test_successor<index<14>>(array, queries, counters));
+    print_result("idx<15>", test_successor<index<15>>(array, queries, counters));
+    print_result("idx<16>", test_successor<index<16>>(array, queries, counters));
     #endif
-    print_result("j_index", test_successor<j_index>(array, queries));
-    print_result("pgm<4>", test_successor<pgm_index<4>>(array, queries));
-    print_result("pgm<8>", test_successor<pgm_index<8>>(array, queries));
-    print_result("pgm<12>", test_successor<pgm_index<12>>(array, queries));
-    print_result("pgm<16>", test_successor<pgm_index<16>>(array, queries));
-    print_result("pgm<20>", test_successor<pgm_index<20>>(array, queries));
-    print_result("pgm<24>", test_successor<pgm_index<24>>(array, queries));
-    print_result("pgm<32>", test_successor<pgm_index<32>>(array, queries));
-    print_result("pgm<48>", test_successor<pgm_index<48>>(array, queries));
-    print_result("pgm<64>", test_successor<pgm_index<64>>(array, queries));
-    print_result("pgm<80>", test_successor<pgm_index<80>>(array, queries));
-    print_result("pgm<96>", test_successor<pgm_index<96>>(array, queries));
-    print_result("pgm<112>", test_successor<pgm_index<112>>(array, queries));
-    print_result("pgm<128>", test_successor<pgm_index<128>>(array, queries));
-    print_result("pgm<256>", test_successor<pgm_index<256>>(array, queries));
-    print_result("pgm<512>", test_successor<pgm_index<512>>(array, queries));
+    print_result("j_index", test_successor<j_index>(array, queries, counters));
+    print_result("pgm<4>", test_successor<pgm_index<4>>(array, queries, counters));
+    print_result("pgm<8>", test_successor<pgm_index<8>>(array, queries, counters));
+    print_result("pgm<12>", test_successor<pgm_index<12>>(array, queries, counters));
+    print_result("pgm<16>", test_successor<pgm_index<16>>(array, queries, counters));
+    print_result("pgm<20>", test_successor<pgm_index<20>>(array, queries, counters));
+    print_result("pgm<24>", test_successor<pgm_index<24>>(array, queries, counters));
+    print_result("pgm<32>", test_successor<pgm_index<32>>(array, queries, counters));
+    print_result("pgm<48>", test_successor<pgm_index<48>>(array, queries, counters));
+    print_result("pgm<64>", test_successor<pgm_index<64>>(array, queries, counters));
+    print_result("pgm<80>", test_successor<pgm_index<80>>(array, queries, counters));
+    print_result("pgm<96>", test_successor<pgm_index<96>>(array, queries, counters));
+    print_result("pgm<112>", test_successor<pgm_index<112>>(array, queries, counters));
+    print_result("pgm<128>", test_successor<pgm_index<128>>(array, queries, counters));
+    print_result("pgm<256>", test_successor<pgm_index<256>>(array, queries, counters));
+    print_result("pgm<512>", test_successor<pgm_index<512>>(array, queries, counters));
     }
 }
@@ -0,0 +1,211 @@
+/*******************************************************************************
+ * benchmark/bench_replay.cpp
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <tlx/cmdline_parser.hpp>
+
+#include "io.hpp"
+#include "lce_factory.hpp"
+#include "util/lce_interface.hpp"
+#include "util/trace_recorder.hpp"
+
+using lce_test::trace_record;
+
+/* Replays a trace of trace_recorder on an LCE data structure. The queries of
+ * recorded thread r are issued by thread r % threads in the order of their
+ * time. With a speed s > 0, a query is issued (time - first time) / s after
+ * the start. Its latency is measured from then, so a replay that cannot
+ * keep up shows the waiting time in the latency, too. With s = 0, the
+ * queries are issued as fast as possible and the latency is the time of the
+ * query alone. */
+class lce_replay {
+public:
+  std::string file_path;
+  std::string trace_path;
+  std::string algorithm = "s512";
+  bool prefer_long_queries = false;
+  bool load = false;
+  uint32_t threads = 0;
+  double speed = 0;
+  bool check = false;
+
+  void run() {
+    lce_test::trace_file const trace(trace_path);
+    std::span<trace_record const> const records = trace.records();
+    open_index();
+    if (trace.text_size() != lce_->getSizeInBytes()) {
+      throw std::runtime_error("The trace belongs to a text of another length");
+    }
+
+    uint32_t recorded_threads = 0;
+    uint64_t first_time = std::numeric_limits<uint64_t>::max();
+    for (auto const& r : records) {
+      recorded_threads = std::max<uint32_t>(recorded_threads, r.thread + 1);
+      first_time = std::min(first_time, r.time_ns);
+    }
+    uint32_t const nt = std::max<uint32_t>(threads > 0 ? threads : recorded_threads, 1);
+
+    // The records of each replay thread in the order of their time
+    std::vector<std::vector<size_t>> schedule(nt);
+    for (size_t k = 0; k < records.size(); ++k) {
+      schedule[records[k].thread % nt].push_back(k);
+    }
+    for (auto& s : schedule) {
+      std::stable_sort(s.begin(), s.end(), [&](size_t const a, size_t const b) {
+        return records[a].time_ns < records[b].time_ns;
+      });
+    }
+
+    std::vector<std::vector<uint64_t>> latencies(nt);
+    std::atomic<uint64_t> wrong = 0;
+    auto const start = std::chrono::steady_clock::now() + std::chrono::milliseconds(10);
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < nt; ++t) {
+      workers.emplace_back([&, t] {
+        std::vector<uint64_t>& latency = latencies[t];
+        latency.reserve(schedule[t].size());
+        uint64_t local_wrong = 0;
+        std::this_thread::sleep_until(start);
+        for (size_t const k : schedule[t]) {
+          trace_record const& r = records[k];
+          auto issue = std::chrono::steady_clock::now();
+          if (speed > 0) {
+            issue = start + std::chrono::nanoseconds(
+                static_cast<uint64_t>((r.time_ns - first_time) / speed));
+            wait_until(issue);
+          }
+          uint64_t result;
+          if (r.flags & trace_record::kCompare) {
+            result = lce_->isSmallerSuffix(r.i, r.j);
+          } else {
+            result = std::min<uint64_t>(lce_->lce(r.i, r.j), std::numeric_limits<uint32_t>::max());
+          }
+          auto const done = std::chrono::steady_clock::now();
+          latency.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(done - issue).count());
+          local_wrong += (result != r.result);
+        }
+        wrong += local_wrong;
+      });
+    }
+    for (auto& w : workers) {
+      w.join();
+    }
+    auto const end = std::chrono::steady_clock::now();
+
+    std::vector<uint64_t> all;
+    all.reserve(records.size());
+    for (auto const& l : latencies) {
+      all.insert(all.end(), l.begin(), l.end());
+    }
+    std::sort(all.begin(), all.end());
+    double const time_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    std::cout << "RESULT "
+              << "algo=" << algorithm << "_replay "
+              << "input=" << file_path << " "
+              << "trace=" << trace_path << " "
+              << "threads=" << nt << " "
+              << "recorded_threads=" << recorded_threads << " "
+              << "speed=" << speed << " "
+              << "queries=" << records.size() << " "
+              << "time=" << time_ms << " "
+              << "throughput=" << (time_ms > 0 ? records.size() / time_ms * 1000 : 0) << " "
+              << "latency_p50=" << percentile(all, 0.5) << " "
+              << "latency_p90=" << percentile(all, 0.9) << " "
+              << "latency_p99=" << percentile(all, 0.99) << " "
+              << "latency_p999=" << percentile(all, 0.999) << " "
+              << "latency_max=" << (all.empty() ? 0 : all.back()) << " ";
+    if (check) {
+      std::cout << "wrong_queries=" << wrong.load() << " ";
+    }
+    std::cout << std::endl;
+  }
+
+private:
+  text_file text_;
+  std::unique_ptr<LceDataStructure> lce_;
+
+  void open_index() {
+    lce_candidate c;
+    c.name = algorithm;
+    c.prefer_long = prefer_long_queries;
+    if (load) {
+      lce_ = LceFactory::open(c, file_path);
+      return;
+    }
+    text_ = map_text(file_path);
+    if (algorithm == "auto") {
+      c = LceFactory(text_.span()).best();
+    }
+    lce_ = (c.name == "p") ? LceFactory::build(c, text_.vector()) : LceFactory::build(c, text_.span());
+  }
+
+  /* Sleeping is too coarse for the gaps between queries, so we spin for the
+     last part of the wait. */
+  static void wait_until(std::chrono::steady_clock::time_point const time) {
+    constexpr auto kSpin = std::chrono::microseconds(100);
+    auto now = std::chrono::steady_clock::now();
+    if (time - now > kSpin) {
+      std::this_thread::sleep_until(time - kSpin);
+    }
+    while (std::chrono::steady_clock::now() < time) { }
+  }
+
+  /* The latency in ns that a share q of the queries does not exceed */
+  static uint64_t percentile(std::vector<uint64_t> const& sorted, double const q) {
+    if (sorted.empty()) {
+      return 0;
+    }
+    size_t const k = std::ceil(q * sorted.size());
+    return sorted[std::clamp<size_t>(k, 1, sorted.size()) - 1];
+  }
+};
+
+int32_t main(int32_t argc, char *argv[]) {
+  lce_replay replay;
+
+  tlx::CmdlineParser cp;
+  cp.set_description("This program replays a query trace that was written "
+                     "by trace_recorder (e.g., with --record of bench_time) "
+                     "and reports the throughput and latency percentiles.");
+
+  cp.add_param_string("file", replay.file_path, "The text or, with --load, "
+                      "the file written with --save of bench_time.");
+  cp.add_param_string("trace", replay.trace_path, "The trace.");
+  cp.add_string('a', "algorithm", replay.algorithm, "LCE data structure, "
+                "see bench_time (default: s512).");
+  cp.add_flag('l', "long", replay.prefer_long_queries, "Prefer long queries. "
+              "Only for [s]tring synchronizing sets.");
+  cp.add_flag("load", replay.load, "Memory map the data structure from the "
+              "file instead of building it.");
+  cp.add_uint('t', "threads", replay.threads, "Number of threads (default: "
+              "the number of recorded threads).");
+  cp.add_double('s', "speed", replay.speed, "Replay speed: 1 replays at the "
+                "recorded times, 2 twice as fast, 0 as fast as possible "
+                "(default: 0).");
+  cp.add_flag('c', "check", replay.check, "Compare the results with the "
+              "recorded ones.");
+
+  if (!cp.process(argc, argv)) {
+    std::exit(EXIT_FAILURE);
+  }
+
+  replay.run();
+  return 0;
+}
+
+/******************************************************************************/
@@ -16,12 +16,26 @@
 #include "lce_prezza.hpp"
 #include "lce_semi_synchronizing_sets_par.hpp"
 #include "timer.hpp"
+#include "util/perf_counters.hpp"
 
 int main(int argc, char** argv) {
-  if (argc != 4) {
-    std::cout << "Use: bench_sparse_ss text_path sample_distance algo\n";
+  if (argc != 4 && !(argc == 5 && std::string(argv[4]) == "--perf")) {
+    std::cout << "Use: bench_sparse_ss text_path sample_distance algo [--perf]\n";
     return -1;
   }
+  // With --perf, the RESULT lines also contain hardware performance counters.
+  lce_test::perf_counters const perf(argc == 5);
+  if (argc == 5 && !perf.available()) {
+    std::cout << "Hardware performance counters are not available\n";
+  }
+  auto print_perf = [&perf](lce_test::perf_sample const& begin, lce_test::perf_sample const& construct) {
+    if (perf.available()) {
+      std::cout << " ";
+      (perf.read() - begin).print(std::cout, "");
+      construct.print(std::cout, "constr_");
+    }
+    std::cout << "\n";
+  };
   std::filesystem::path text_path = argv[1];
   std::string text_name = text_path.filename();
   size_t sample_distance = std::stoi(argv[2]);
@@ -67,6 +81,8 @@ int main(int argc, char** argv) {
     malloc_count_reset_peak();
     auto mem_before = malloc_count_current();
     timer t;
+    lce_test::perf_sample const perf_begin = perf.read();
+    lce_test::perf_sample perf_construct;
     LceNaive lce_ds(text);
     std::sort(positions.begin(), positions.end(), [&lce_ds, &text_size, &text](size_t i, size_t j) {
       size_t lce = lce_ds.lce(i, j);
@@ -82,14 +98,16 @@ int main(int argc, char** argv) {
               << " sample_distance=" << sample_distance
               << " text_name=" << text_name
               << " mem_ds=" << malloc_count_current() - mem_before
-              << " mem_peak=" << malloc_count_peak() - mem_before
-              << "\n";
+              << " mem_peak=" << malloc_count_peak() - mem_before;
+    print_perf(perf_begin, perf_construct);
   }
   // Memcmp
   if (algo == 1) {
     malloc_count_reset_peak();
     auto mem_before = malloc_count_current();
     timer t;
+    lce_test::perf_sample const perf_begin = perf.read();
+    lce_test::perf_sample perf_construct;
     std::sort(positions.begin(), positions.end(), [&text_size, &text](size_t i, size_t j) {
       return (std::memcmp(text.data() + i, text.data() + j, text_size - std::max(i, j)) < 0);
     });
@@ -97,8 +115,8 @@ int main(int argc, char** argv) {
               << " sample_distance=" << sample_distance
               << " text_name=" << text_name
               << " mem_ds=" << malloc_count_current() - mem_before
-              << " mem_peak=" << malloc_count_peak() - mem_before
-              << "\n";
+              << " mem_peak=" << malloc_count_peak() - mem_before;
+    print_perf(perf_begin, perf_construct);
   }
 
   // In-Place Fingerprinting
@@ -108,9 +126,12 @@ int main(int argc, char** argv) {
 
     auto mem_before = malloc_count_current();
     timer t;
+    lce_test::perf_sample const perf_begin = perf.read();
+    lce_test::perf_sample perf_construct;
     timer t_construct;
     LcePrezza lce_ds(reinterpret_cast<uint64_t*>(text.data()), text.size());
     auto constr_time = t.get();
+    perf_construct = perf.read() - perf_begin;
 
     timer t_sort;
     std::sort(positions.begin(), positions.end(), [&lce_ds, &text_size, &text](size_t i, size_t j) {
@@ -136,8 +157,8 @@ int main(int argc, char** argv) {
               << " sort_time=" << sort_time
               << " reconstruct_time=" << reconstruct_time
               << " mem_ds=" << malloc_count_current() - mem_before
-              << " mem_peak=" << malloc_count_peak() - mem_before
-              << "\n";
+              << " mem_peak=" << malloc_count_peak() - mem_before;
+    print_perf(perf_begin, perf_construct);
   }
 
   // SSS
@@ -145,8 +166,11 @@ int main(int argc, char** argv) {
     malloc_count_reset_peak();
     auto mem_before = malloc_count_current();
     timer t;
+    lce_test::perf_sample const perf_begin = perf.read();
+    lce_test::perf_sample perf_construct;
     lce_test::par::LceSemiSyncSetsPar<256> lce_ds(text, false);
     auto constr_time = t.get();
+    perf_construct = perf.read() - perf_begin;
     std::sort(positions.begin(), positions.end(), [&lce_ds, &text_size, &text](size_t i, size_t j) {
       size_t lce = lce_ds.lce(i, j);
       if (i + lce >= text_size) [[unlikely]] {
@@ -162,15 +186,18 @@ int main(int argc, char** argv) {
               << " text_name=" << text_name
               << " constr_time=" << constr_time
               << " mem_ds=" << malloc_count_current() - mem_before
-              << " mem_peak=" << malloc_count_peak() - mem_before
-              << "\n";
+              << " mem_peak=" << malloc_count_peak() - mem_before;
+    print_perf(perf_begin, perf_construct);
   }
   if (algo == 4) {
     malloc_count_reset_peak();
     auto mem_before = malloc_count_current();
     timer t;
+    lce_test::perf_sample const perf_begin = perf.read();
+    lce_test::perf_sample perf_construct;
     lce_test::par::LceSemiSyncSetsPar<512> lce_ds(text, false);
     auto constr_time = t.get();
+    perf_construct = perf.read() - perf_begin;
     std::sort(positions.begin(), positions.end(), [&lce_ds, &text_size, &text](size_t i, size_t j) {
       size_t lce = lce_ds.lce(i, j);
       if (i + lce >= text_size) [[unlikely]] {
@@ -186,15 +213,18 @@ int main(int argc, char** argv) {
               << " text_name=" << text_name
               << " constr_time=" << constr_time
               << " mem_ds=" << malloc_count_current() - mem_before
-              << " mem_peak=" << malloc_count_peak() - mem_before
-              << "\n";
+              << " mem_peak=" << malloc_count_peak() - mem_before;
+    print_perf(perf_begin, perf_construct);
   }
   if (algo == 5) {
     malloc_count_reset_peak();
     auto mem_before = malloc_count_current();
     timer t;
+    lce_test::perf_sample const perf_begin = perf.read();
+    lce_test::perf_sample perf_construct;
     lce_test::par::LceSemiSyncSetsPar<1024> lce_ds(text, false);
     auto constr_time = t.get();
+    perf_construct = perf.read() - perf_begin;
     std::sort(positions.begin(), positions.end(), [&lce_ds, &text_size, &text](size_t i, size_t j) {
       size_t lce = lce_ds.lce(i, j);
       if (i + lce >= text_size) [[unlikely]] {
@@ -210,15 +240,18 @@ int main(int argc, char** argv) {
               << " text_name=" << text_name
               << " constr_time=" << constr_time
               << " mem_ds=" << malloc_count_current() - mem_before
-              << " mem_peak=" << malloc_count_peak() - mem_before
-              << "\n";
+              << " mem_peak=" << malloc_count_peak() - mem_before;
+    print_perf(perf_begin, perf_construct);
   }
   if (algo == 6) {
     malloc_count_reset_peak();
     auto mem_before = malloc_count_current();
     timer t;
+    lce_test::perf_sample const perf_begin = perf.read();
+    lce_test::perf_sample perf_construct;
     lce_test::par::LceSemiSyncSetsPar<2048> lce_ds(text, false);
     auto constr_time = t.get();
+    perf_construct = perf.read() - perf_begin;
     std::sort(positions.begin(), positions.end(), [&lce_ds, &text_size, &text](size_t i, size_t j) {
       size_t lce = lce_ds.lce(i, j);
       if (i + lce >= text_size) [[unlikely]] {
@@ -234,8 +267,8 @@ int main(int argc, char** argv) {
               << " text_name=" << text_name
               << " constr_time=" << constr_time
               << " mem_ds=" << malloc_count_current() - mem_before
-              << " mem_peak=" << malloc_count_peak() - mem_before
-              << "\n";
+              << " mem_peak=" << malloc_count_peak() - mem_before;
+    print_perf(perf_begin, perf_construct);
   }
 
   // String Sorting
@@ -247,6 +280,8 @@ int main(int argc, char** argv) {
     malloc_count_reset_peak();
     auto mem_before = malloc_count_current();
     timer t;
+    lce_test::perf_sample const perf_begin = perf.read();
+    lce_test::perf_sample perf_construct;
     tlx::sort_strings_detail::StringSuffixSet string_suf_set(str, positions.begin(), positions.end());
     tlx::sort_strings_detail::StringPtr strptr(string_suf_set);
     tlx::sort_strings_detail::parallel_sample_sort(strptr, 0, 0);
@@ -255,8 +290,8 @@ int main(int argc, char** argv) {
               << " sample_distance=" << sample_distance
               << " text_name=" << text_name
               << " mem_ds=" << malloc_count_current() - mem_before
-              << " mem_peak=" << malloc_count_peak() - mem_before
-              << "\n";
+              << " mem_peak=" << malloc_count_peak() - mem_before;
+    print_perf(perf_begin, perf_construct);
   }
 
   // Libsais
@@ -264,13 +299,15 @@ int main(int argc, char** argv) {
     malloc_count_reset_peak();
     auto mem_before = malloc_count_current();
     timer t;
+    lce_test::perf_sample const perf_begin = perf.read();
+    lce_test::perf_sample perf_construct;
     libsais(text.data(), reinterpret_cast<int32_t*>(positions.data()), text_size, 0, nullptr);
     std::cout << "RESULT algo=libsais time=" << t.get()
               << " sample_distance=" << sample_distance
               << " text_name=" << text_name
               << " mem_ds=" << malloc_count_current() - mem_before
-              << " mem_peak=" << malloc_count_peak() - mem_before
-              << "\n";
+              << " mem_peak=" << malloc_count_peak() - mem_before;
+    print_perf(perf_begin, perf_construct);
   }
 
   // Check if text is the same as before
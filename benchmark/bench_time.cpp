@@ -10,28 +10,46 @@
 
 #include <malloc_count.h>
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <sys/time.h>
+#include <unistd.h>
 #include <vector>
 #include <iomanip>
 
 #include <filesystem>
 
 #include <memory>
+#include <optional>
+#include <sstream>
 
 #include <tlx/cmdline_parser.hpp>
 #include <tlx/math/aggregate.hpp>
+#include <tlx/string/parse_si_iec_units.hpp>
 
 #include "io.hpp"
+#include "query_workload.hpp"
+#include "text_generator.hpp"
 #include "timer.hpp"
 #include "build_lce_ranges.hpp"
+#include "lce_factory.hpp"
 #include "lce_naive.hpp"
 #include "lce_naive_ultra.hpp"
 #include "lce_prezza.hpp"
 #include "lce_prezza_mersenne.hpp"
 #include "lce_semi_synchronizing_sets.hpp"
+#include "util/io_stats.hpp"
+#include "util/latency_histogram.hpp"
+#include "util/perf_counters.hpp"
+#include "util/phase_profiler.hpp"
+#include "util/query_stats.hpp"
+#include "util/timeline.hpp"
+#include "util/query_file.hpp"
+#include "util/trace_recorder.hpp"
 
 #ifdef ALLOW_PARALLEL
+#include "lce_semi_synchronizing_sets_external.hpp"
 #include "lce_semi_synchronizing_sets_par.hpp"
 #endif
 #ifdef LCE_BUILD_SDSL
@@ -44,6 +62,13 @@ class lce_benchmark {
 
 public:
   void run() {
+    if (file_path.starts_with("gen:")) {
+      file_path = generated_text(file_path.substr(4));
+    }
+    if (sweep) {
+      run_sweep();
+      return;
+    }
  
     fs::path text_path(file_path);
     std::string const filename = text_path.filename();
@@ -74,72 +99,108 @@ public:
      ************************************/
 
     std::unique_ptr<LceDataStructure> lce_structure;
-    std::vector<uint8_t> text;
+    text_file text;
 
     timer t;
     tlx::Aggregate<size_t> construction_times;
     tlx::Aggregate<size_t> construction_mem_peak;
     tlx::Aggregate<size_t> lce_mem;
 
+    if (algorithm == "auto") {
+      choose_algorithm(text_path, lce_path, lce_set);
+    }
+    if (external && (save_path.empty() || !uses_sss())) {
+      throw std::runtime_error("--external needs --save and [s]tring synchronizing sets");
+    }
+
     std::cout << "RESULT "
               << "algo=" << print_algo_name() << " "
               << "runs=" << runs << " ";
 
+    perf_.emplace(perf);
+    lce_test::perf_sample construction_perf;
+    lce_test::phase_profiler& profiler = lce_test::phase_profiler::global();
+    profiler.set_memory_counter([] { return static_cast<int64_t>(malloc_count_current()); });
+    // The hardware events of the phases; perf_ outlives the constructions.
+    profiler.set_perf_counters(perf_->available() ? &*perf_ : nullptr);
+    profiler.clear();
     for (size_t i = 0; i < runs; ++i) {
-      text = load_text(text_path, prefix_length);
+      text = open_text(text_path);
 
       auto* old_structure = lce_structure.release();
       if (old_structure != nullptr) {
         delete old_structure;
       }
+      // Only the first construction is traced.
+      if (i == 0 && !trace_path.empty()) {
+        lce_test::timeline::global().clear();
+        lce_test::timeline::global().enable();
+      }
+      lce_test::timeline::span construction_span("construction");
+      lce_test::perf_counters::phase construction(*perf_, construction_perf);
+      if (!load_path.empty()) {
+        size_t const mem_before = malloc_count_current();
+        t.reset();
+        lce_structure = open_index(load_path);
+        construction_times.add(t.get_and_reset());
+        lce_mem.add(malloc_count_current() - mem_before);
+        construction_mem_peak.add(malloc_count_peak() - mem_before);
+        continue;
+      }
+#ifdef ALLOW_PARALLEL
+      if (external) {
+        size_t const mem_before = malloc_count_current();
+        t.reset();
+        build_external(text_path);
+        lce_structure = open_index(save_path);
+        construction_times.add(t.get_and_reset());
+        lce_mem.add(malloc_count_current() - mem_before);
+        construction_mem_peak.add(malloc_count_peak() - mem_before);
+        continue;
+      }
+#endif
       if (algorithm == "u") {
         size_t const mem_before = malloc_count_current();
         t.reset();
-        lce_structure = std::make_unique<LceUltraNaive>(text);
+        lce_structure = std::make_unique<LceUltraNaive>(text.span());
         construction_times.add(t.get_and_reset());
         lce_mem.add(malloc_count_current() - mem_before);
         construction_mem_peak.add(malloc_count_peak() - mem_before);
       } else if (algorithm == "n") {
         size_t const mem_before = malloc_count_current();
         t.reset();
-        lce_structure = std::make_unique<LceNaive>(text);
+        lce_structure = std::make_unique<LceNaive>(text.span());
         construction_times.add(t.get_and_reset());
         lce_mem.add(malloc_count_current() - mem_before);
         construction_mem_peak.add(malloc_count_peak() - mem_before);
       } else if (algorithm == "m") {
         t.reset();
-        lce_structure = std::make_unique<rklce::LcePrezzaMersenne>(text);
+        lce_structure = std::make_unique<rklce::LcePrezzaMersenne>(text.span());
         construction_times.add(t.get_and_reset());
       } else if (algorithm == "p") {
+        // Prezza's data structure overwrites the text, so it cannot be mapped.
+        std::vector<uint8_t>& blocks = text.vector();
         // Make sure the text can be divided into 64 bit blocks
-        text.resize(text.size() + (8 - (text.size() % 8)));
+        blocks.resize(blocks.size() + (8 - (blocks.size() % 8)));
         size_t const mem_before = malloc_count_current();
         t.reset();
         lce_structure =
-          std::make_unique<LcePrezza<128>>(reinterpret_cast<uint64_t*>(text.data()),
-                                      text.size());
+          std::make_unique<LcePrezza<128>>(reinterpret_cast<uint64_t*>(blocks.data()),
+                                      blocks.size());
         construction_times.add(t.get_and_reset());
         lce_mem.add(malloc_count_current() - mem_before);
         construction_mem_peak.add(malloc_count_peak() - mem_before);
       } else if (algorithm == "s2048") {
         size_t const mem_before = malloc_count_current();
         t.reset();
-        if (prefer_long_queries) {
-          lce_structure = std::make_unique<LceSemiSyncSets<2048, true>>(text, i == 0);
-        } else {
-          lce_structure = std::make_unique<LceSemiSyncSets<2048, false>>(text, i == 0);
-        }
+        lce_structure = make_sss<2048, lce_test::execution::sequential>(text, i == 0);
         construction_times.add(t.get_and_reset());
         lce_mem.add(malloc_count_current() - mem_before);
         construction_mem_peak.add(malloc_count_peak() - mem_before);
       } else if (algorithm == "s1024") {
         size_t const mem_before = malloc_count_current();
         t.reset();
-        if (prefer_long_queries) {
-          lce_structure = std::make_unique<LceSemiSyncSets<1024, true>>(text, i == 0);
-        } else {
-          lce_structure = std::make_unique<LceSemiSyncSets<1024, false>>(text, i == 0);
-        }
+        lce_structure = make_sss<1024, lce_test::execution::sequential>(text, i == 0);
         construction_times.add(t.get_and_reset());
         lce_mem.add(malloc_count_current() - mem_before);
         construction_mem_peak.add(malloc_count_peak() - mem_before);
@@ -147,22 +208,23 @@ public:
       } else if (algorithm == "s512" || algorithm == "s") {
         size_t const mem_before = malloc_count_current();
         t.reset();
-        if (prefer_long_queries) {
-          lce_structure = std::make_unique<LceSemiSyncSets<512, true>>(text, i == 0);
-        } else {
-          lce_structure = std::make_unique<LceSemiSyncSets<512, false>>(text, i == 0);
-        }
+        lce_structure = make_sss<512, lce_test::execution::sequential>(text, i == 0);
         construction_times.add(t.get_and_reset());
         lce_mem.add(malloc_count_current() - mem_before);
         construction_mem_peak.add(malloc_count_peak() - mem_before);
       } else if (algorithm == "s256") {
         size_t const mem_before = malloc_count_current();
         t.reset();
-        if (prefer_long_queries) {
-          lce_structure = std::make_unique<LceSemiSyncSets<256, true>>(text, i == 0);
-        } else {
-          lce_structure = std::make_unique<LceSemiSyncSets<256, false>>(text, i == 0);
-        }
+        lce_structure = make_sss<256, lce_test::execution::sequential>(text, i == 0);
+        construction_times.add(t.get_and_reset());
+        lce_mem.add(malloc_count_current() - mem_before);
+        construction_mem_peak.add(malloc_count_peak() - mem_before);
+      } else if (algorithm == "auto") {
+        size_t const mem_before = malloc_count_current();
+        t.reset();
+        lce_structure = (auto_choice.name == "p") ?
+          LceFactory::build(auto_choice, text.vector()) :
+          LceFactory::build(auto_choice, text.span());
         construction_times.add(t.get_and_reset());
         lce_mem.add(malloc_count_current() - mem_before);
         construction_mem_peak.add(malloc_count_peak() - mem_before);
@@ -171,50 +233,62 @@ public:
       else if (algorithm == "s2048_par") {
         size_t const mem_before = malloc_count_current();
         t.reset();
-        if (prefer_long_queries) {
-          lce_structure = std::make_unique<lce_test::par::LceSemiSyncSetsPar<2048>>(text, i == 0);
-        } else {
-          lce_structure = std::make_unique<lce_test::par::LceSemiSyncSetsPar<2048>>(text, i == 0);
-        }
+        lce_structure = make_sss<2048, lce_test::execution::default_policy>(text, i == 0);
         construction_times.add(t.get_and_reset());
         lce_mem.add(malloc_count_current() - mem_before);
         construction_mem_peak.add(malloc_count_peak() - mem_before);
       } else if (algorithm == "s1024_par") {
         size_t const mem_before = malloc_count_current();
         t.reset();
-        if (prefer_long_queries) {
-          lce_structure = std::make_unique<lce_test::par::LceSemiSyncSetsPar<1024>>(text, i == 0);
-        } else {
-          lce_structure = std::make_unique<lce_test::par::LceSemiSyncSetsPar<1024>>(text, i == 0);
-        }
+        lce_structure = make_sss<1024, lce_test::execution::default_policy>(text, i == 0);
         construction_times.add(t.get_and_reset());
         lce_mem.add(malloc_count_current() - mem_before);
         construction_mem_peak.add(malloc_count_peak() - mem_before);
-        construction_mem_peak.add(malloc_count_peak() - mem_before);
       } else if (algorithm == "s512_par" || algorithm == "s_par") {
         size_t const mem_before = malloc_count_current();
         t.reset();
-        if (prefer_long_queries) {
-          lce_structure = std::make_unique<lce_test::par::LceSemiSyncSetsPar<512>>(text, i == 0);
-        } else {
-          lce_structure = std::make_unique<lce_test::par::LceSemiSyncSetsPar<512>>(text, i == 0);
-        }
+        lce_structure = make_sss<512, lce_test::execution::default_policy>(text, i == 0);
         construction_times.add(t.get_and_reset());
         lce_mem.add(malloc_count_current() - mem_before);
         construction_mem_peak.add(malloc_count_peak() - mem_before);
       } else if (algorithm == "s256_par") {
         size_t const mem_before = malloc_count_current();
         t.reset();
-        if (prefer_long_queries) {
-          lce_structure = std::make_unique<lce_test::par::LceSemiSyncSetsPar<256>>(text, i == 0);
-        } else {
-          lce_structure = std::make_unique<lce_test::par::LceSemiSyncSetsPar<256>>(text, i == 0);
-        }
+        lce_structure = make_sss<256, lce_test::execution::default_policy>(text, i == 0);
         construction_times.add(t.get_and_reset());
         lce_mem.add(malloc_count_current() - mem_before);
         construction_mem_peak.add(malloc_count_peak() - mem_before);
       }
 #endif
+      else if (algorithm == "s2048_hier") {
+        size_t const mem_before = malloc_count_current();
+        t.reset();
+        lce_structure = make_sss<2048, lce_test::execution::default_policy, true>(text, i == 0);
+        construction_times.add(t.get_and_reset());
+        lce_mem.add(malloc_count_current() - mem_before);
+        construction_mem_peak.add(malloc_count_peak() - mem_before);
+      } else if (algorithm == "s1024_hier") {
+        size_t const mem_before = malloc_count_current();
+        t.reset();
+        lce_structure = make_sss<1024, lce_test::execution::default_policy, true>(text, i == 0);
+        construction_times.add(t.get_and_reset());
+        lce_mem.add(malloc_count_current() - mem_before);
+        construction_mem_peak.add(malloc_count_peak() - mem_before);
+      } else if (algorithm == "s512_hier" || algorithm == "s_hier") {
+        size_t const mem_before = malloc_count_current();
+        t.reset();
+        lce_structure = make_sss<512, lce_test::execution::default_policy, true>(text, i == 0);
+        construction_times.add(t.get_and_reset());
+        lce_mem.add(malloc_count_current() - mem_before);
+        construction_mem_peak.add(malloc_count_peak() - mem_before);
+      } else if (algorithm == "s256_hier") {
+        size_t const mem_before = malloc_count_current();
+        t.reset();
+        lce_structure = make_sss<256, lce_test::execution::default_policy, true>(text, i == 0);
+        construction_times.add(t.get_and_reset());
+        lce_mem.add(malloc_count_current() - mem_before);
+        construction_mem_peak.add(malloc_count_peak() - mem_before);
+      }
 
 #ifdef LCE_BUILD_SDSL
       else if (algorithm == "sada") {
@@ -235,16 +309,27 @@ public:
       }
 #endif
       else {
+        profiler.set_perf_counters(nullptr);
         return;
       }
+      construction.stop();
+      construction_span.stop();
+      lce_test::timeline::global().disable();
+      if (i == 0 && !save_path.empty()) {
+        lce_structure->save(save_path);
+      }
     }
+    profiler.set_perf_counters(nullptr);
+
+    // Without --pread, text is the text of the data structure.
+    size_t const text_size = (text.size() > 0) ? text.size() : lce_structure->getSizeInBytes();
 
     std::cout << "construction_min_time=" << construction_times.min() << " "
               << "construction_max_time=" << construction_times.max() << " "
               << "construction_avg_time=" << construction_times.avg() << " "
 
               << "input=" << text_path << " "
-              << "size=" << text.size() << " "
+              << "size=" << text_size << " "
 
               << "lce_mem=" << lce_mem.max() << " "
               << "construction_mem_peak=" << construction_mem_peak.max() << " "
@@ -252,74 +337,245 @@ public:
               << "threads=" << omp_get_max_threads() << " "
               #endif
               ;
+    if (perf && !perf_->available()) {
+      std::cout << "perf=unavailable ";
+    }
+    construction_perf.print(std::cout, "construction_", runs);
+    // The parts of the data structure, e.g., space_rmq_isa for "rmq/isa"
+    uint64_t space_total = 0;
+    for (auto const& part : lce_structure->space_breakdown()) {
+      std::string name = part.name;
+      std::replace(name.begin(), name.end(), '/', '_');
+      std::cout << "space_" << name << "=" << part.bytes << " ";
+      space_total += part.bytes;
+    }
+    std::cout << "space_total=" << space_total << " ";
+    // The phases of the constructions (see util/phase_profiler.hpp)
+    profiler.print(std::cout, runs);
     std::cout << std::endl;
+    if (!phases_path.empty()) {
+      std::ofstream phases_out(phases_path);
+      profiler.write_json(phases_out);
+      phases_out << std::endl;
+    }
+    if (!trace_path.empty()) {
+      std::ofstream trace_out(trace_path);
+      lce_test::timeline::global().write_chrome_json(trace_out);
+      trace_out << std::endl;
+    }
 
-    std::vector<uint64_t> lce_indices(number_lce_queries * 2);
-    bool correct = true;
-    size_t wrong_queries = 0;
+    // Every run of a length class is a batch of the trace.
+    lce_test::trace_recorder* recorder = nullptr;
+    if (!record_path.empty()) {
+      auto wrapped = std::make_unique<lce_test::trace_recorder>(std::move(lce_structure), record_path);
+      recorder = wrapped.get();
+      lce_structure = std::move(wrapped);
+    }
 
-    for (size_t i = lce_from; i < lce_to; ++i) {
-      tlx::Aggregate<size_t> queries_times;
-      tlx::Aggregate<size_t> lce_values;
-      std::cout << "RESULT "
-                << "algo=" << print_algo_name() << "_queries "
-                << "runs=" << runs << " "
-                << "length_exp=" << i << " "
-                << "input=" << text_path << " "
-                << "size=" << text.size() << " ";
-      vector<uint64_t> v;
-      std::ifstream lc(lce_set[i], ios::in);
-      util::inputErrorHandling(&lc);
-          
-      string line;
-      string::size_type sz;
-      while(getline(lc, line)) {
-        v.push_back(std::stoll(line, &sz));
+    open_query_file(lce_path, text_path, text_size);
+
+    if (query_mode == "sorted") {
+      for (size_t i = lce_from; i < lce_to; ++i) {
+        std::cout << "RESULT "
+                  << "algo=" << print_algo_name() << "_queries "
+                  << "runs=" << runs << " "
+                  << "lce_query_type=" << query_mode << " "
+                  << "length_exp=" << i << " "
+                  << "input=" << text_path << " "
+                  << "size=" << text_size << " ";
+        // Queries are repeated if there are too few.
+        std::vector<uint64_t> const v = load_queries(lce_set[i], i, number_lce_queries * 2);
+        std::vector<uint64_t> lce_indices;
+        if (v.size() > 0) {
+          lce_indices.resize(number_lce_queries * 2);
+          for (uint64_t j = 0; j < number_lce_queries * 2; ++j) {
+            lce_indices[j] = v[j % v.size()];
+          }
+        }
+        measure_queries(*lce_structure, lce_indices, recorder, text_path);
       }
-      lc.close();
+      return;
+    }
+
+    std::cout << "RESULT "
+              << "algo=" << print_algo_name() << "_queries "
+              << "runs=" << runs << " "
+              << "lce_query_type=" << query_mode << " ";
+    std::vector<uint64_t> lce_indices;
+    if (query_mode == "random") {
+      lce_indices = workload::random_queries(text_size, number_lce_queries, seed);
+    } else if (query_mode == "zipf") {
+      std::cout << "zipf_s=" << zipf_s << " ";
+      lce_indices = workload::zipf_queries(text_size, number_lce_queries, zipf_s, seed);
+    } else if (query_mode == "mixed") {
+      std::vector<std::vector<uint64_t>> classes;
+      std::vector<double> weights;
+      std::istringstream mix_weights(mix);
+      for (size_t i = lce_from; i < lce_to; ++i) {
+        classes.push_back(load_queries(lce_set[i], i, std::numeric_limits<size_t>::max()));
+        std::string weight;
+        weights.push_back(std::getline(mix_weights, weight, ',') ? std::stod(weight) : 1.0);
+      }
+      std::cout << "length_from=" << lce_from << " "
+                << "length_to=" << lce_to << " "
+                << "mix=" << (mix.empty() ? "uniform" : mix) << " ";
+      lce_indices = workload::mixed_queries(classes, weights, number_lce_queries, seed);
+    } else {
+      throw std::runtime_error("Unknown query mode " + query_mode);
+    }
+    std::cout << "seed=" << seed << " "
+              << "input=" << text_path << " "
+              << "size=" << text_size << " ";
+    measure_queries(*lce_structure, lce_indices, recorder, text_path);
+  }
+
+private:
+  std::optional<lce_test::query_file> queries_;
+  std::optional<lce_test::perf_counters> perf_;
+  size_t wrong_queries_ = 0;
+
+  /* genqueries --binary writes all queries to one file that we map. It is
+     only opened once, also if choose_algorithm() opened it before. */
+  void open_query_file(fs::path const& lce_path, fs::path const& text_path,
+                       size_t const text_size) {
+    if (queries_ || !fs::exists(lce_path / "lce_queries.bin")) {
+      return;
+    }
+    queries_.emplace(lce_path / "lce_queries.bin");
+    bool const same_text = (queries_->text_size() == text_size) &&
+      (!check || queries_->text_hash() ==
+       lce_test::query_file::hash_text(load_text(text_path, prefix_length)));
+    if (!same_text) {
+      throw std::runtime_error("The queries in " + std::string(lce_path) +
+                               " belong to another text");
+    }
+  }
+
+  /* Returns the first max_positions positions of the queries of a length
+     class, from lce_queries.bin if there is one. */
+  std::vector<uint64_t> load_queries(std::string const& path, size_t const length_exp,
+                                     size_t const max_positions) const {
+    if (queries_) {
+      return queries_->positions(length_exp, max_positions);
+    }
+    std::vector<uint64_t> v;
+    std::ifstream lc(path, ios::in);
+    util::inputErrorHandling(&lc);
+
+    string line;
+    string::size_type sz;
+    while(v.size() < max_positions && getline(lc, line)) {
+      v.push_back(std::stoll(line, &sz));
+    }
+    return v;
+  }
+
+  /* The time between two reads of the clock, which is subtracted from the
+     latency of a single query. */
+  static uint64_t clock_overhead() {
+    uint64_t result = std::numeric_limits<uint64_t>::max();
+    for (size_t k = 0; k < 1000; ++k) {
+      auto const begin = std::chrono::steady_clock::now();
+      auto const end = std::chrono::steady_clock::now();
+      result = std::min<uint64_t>(result, std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+    }
+    return result;
+  }
 
-      if (v.size() > 0) {
-        for(uint64_t i = 0; i < number_lce_queries * 2; ++i) {
-          lce_indices[i] = v[i % v.size()];
+  /* Answers the query pairs of lce_indices in every run and prints the rest
+     of the RESULT line. */
+  void measure_queries(LceDataStructure& lce_structure, std::vector<uint64_t> const& lce_indices,
+                       lce_test::trace_recorder* const recorder, fs::path const& text_path) {
+    timer t;
+    tlx::Aggregate<size_t> queries_times;
+    tlx::Aggregate<size_t> lce_values;
+    lce_test::latency_histogram latencies;
+    lce_test::perf_sample queries_perf;
+    uint64_t queries_ns = 0;
+    lce_test::io_stats io;
+    lce_test::query_stats::totals stats;
+    bool correct = true;
+    // The latency samples and the checked queries do not belong to the trace.
+    LceDataStructure& unrecorded = (recorder != nullptr) ? recorder->recorded() : lce_structure;
+    if (lce_indices.size() > 0) {
+      lce_test::io_stats const io_before = lce_test::io_stats::now();
+      lce_test::query_stats::reset();
+      for (size_t i = 0; i < runs; ++i) {
+        if (recorder != nullptr) {
+          recorder->begin_batch();
         }
-        for (size_t i = 0; i < runs; ++i) {
-          t.reset();
-          for (size_t j = 0; j < number_lce_queries * 2; j += 2) {
-            size_t const lce = lce_structure->lce(lce_indices[j],
-                                                  lce_indices[j + 1]);
-            lce_values.add(lce);
-          }
-          queries_times.add(t.get_and_reset());
+        lce_test::perf_counters::phase queries(*perf_, queries_perf);
+        t.reset();
+        for (size_t j = 0; j < lce_indices.size(); j += 2) {
+          lce_values.add(lce_structure.lce(lce_indices[j], lce_indices[j + 1]));
         }
-        if (check) {
-          correct = true;
-          auto check_text = load_text(text_path, prefix_length);
-          auto lce_naive = LceUltraNaive(check_text);
-          for (size_t j = 0; j < number_lce_queries * 2; j += 2) {
-            size_t const lce = lce_structure->lce(lce_indices[j],
-                                                  lce_indices[j + 1]);
-            size_t const lce_res_naive = lce_naive.lce(lce_indices[j],
-                                                        lce_indices[j + 1]);
-            if (lce != lce_res_naive) {
-              correct = false;
-              ++wrong_queries;
-            }
+        size_t const time_ns = t.get_ns_and_reset();
+        queries.stop();
+        queries_ns += time_ns;
+        queries_times.add(time_ns / 1000000);
+      }
+      io = lce_test::io_stats::now() - io_before;
+      stats = lce_test::query_stats::collect();
+      if (sample_every > 0) {
+        // Timing single queries slows them down, so the pairs j with
+        // j / 2 % sample_every == 0 are timed in a pass of their own after
+        // the throughput runs.
+        uint64_t const clock_overhead_ns = clock_overhead();
+        for (size_t j = 0; j < lce_indices.size(); j += 2 * sample_every) {
+          auto const begin = std::chrono::steady_clock::now();
+          unrecorded.lce(lce_indices[j], lce_indices[j + 1]);
+          auto const end = std::chrono::steady_clock::now();
+          uint64_t const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+          latencies.add(ns - std::min(ns, clock_overhead_ns));
+        }
+      }
+      if (check) {
+        auto check_text = load_text(text_path, prefix_length);
+        auto lce_naive = LceUltraNaive(check_text);
+        for (size_t j = 0; j < lce_indices.size(); j += 2) {
+          size_t const lce = unrecorded.lce(lce_indices[j],
+                                            lce_indices[j + 1]);
+          size_t const lce_res_naive = lce_naive.lce(lce_indices[j],
+                                                      lce_indices[j + 1]);
+          if (lce != lce_res_naive) {
+            correct = false;
+            ++wrong_queries_;
           }
         }
       }
-      std::cout << "lce_values_min=" << lce_values.min() << " "
-                << "lce_values_max=" << lce_values.max() << " "
-                << "lce_values_avg=" << lce_values.avg() << " "
-                << "lce_values_count=" << lce_values.count() << " "
-                << "queries_times_min=" << queries_times.min() << " "
-                << "queries_times_max=" << queries_times.max() << " "
-                << "queries_times_avg=" << queries_times.avg() << " "
-                << "check="
-                << (check ? (correct ? "passed" :
-                              ("failed(" + std::to_string(wrong_queries)
-                              + ")" )) : "none") << " "
-                << std::endl;
     }
+    std::cout << "lce_values_min=" << lce_values.min() << " "
+              << "lce_values_max=" << lce_values.max() << " "
+              << "lce_values_avg=" << lce_values.avg() << " "
+              << "lce_values_count=" << lce_values.count() << " "
+              << "queries_times_min=" << queries_times.min() << " "
+              << "queries_times_max=" << queries_times.max() << " "
+              << "queries_times_avg=" << queries_times.avg() << " "
+              << "ns_per_query=" << (lce_values.count() > 0 ? double(queries_ns) / lce_values.count() : 0) << " ";
+    if (sample_every > 0) {
+      std::cout << "latency_samples=" << latencies.count() << " "
+                << "latency_p50=" << latencies.percentile(0.5) << " "
+                << "latency_p90=" << latencies.percentile(0.9) << " "
+                << "latency_p99=" << latencies.percentile(0.99) << " "
+                << "latency_p999=" << latencies.percentile(0.999) << " "
+                << "latency_max=" << latencies.max() << " ";
+    }
+    // Per query
+    queries_perf.print(std::cout, "query_", std::max<double>(1, lce_values.count()));
+    if constexpr (lce_test::query_stats::enabled) {
+      // Of all runs
+      stats.print(std::cout);
+    }
+    if (semi_external) {
+      double const queries = std::max<double>(1, lce_values.count());
+      std::cout << "io_faults_per_query=" << io.major_faults / queries << " "
+                << "io_bytes_per_query=" << io.read_bytes / queries << " ";
+    }
+    std::cout << "check="
+              << (check ? (correct ? "passed" :
+                            ("failed(" + std::to_string(wrong_queries_)
+                            + ")" )) : "none") << " "
+              << std::endl;
   }
 
 
@@ -330,16 +586,457 @@ public:
 
   std::string algorithm = "u";
   bool prefer_long_queries = false;
+  bool adaptive_queries = false;
 
   bool check = false;
 
   size_t number_lce_queries = 1000000;
   uint32_t runs = 5;
+  size_t sample_every = 16;
+  bool perf = false;
+
+  std::string query_mode = "sorted";
+  size_t seed = 1;
+  double zipf_s = 1.0;
+  std::string mix;
 
   uint32_t lce_from = 0;
   uint32_t lce_to = 21;
 
+  uint64_t memory_budget = std::numeric_limits<uint64_t>::max();
+
+  bool mmap_text = false;
+  bool parallel_load = false;
+  bool huge_pages = false;
+
+  std::string save_path;
+  std::string load_path;
+  bool populate = false;
+  bool semi_external = false;
+
+  std::string record_path;
+  std::string phases_path;
+  std::string trace_path;
+
+  bool external = false;
+  uint64_t ram_budget = uint64_t{1} << 30;
+  std::string tmp_dir = "/tmp";
+
+  bool sweep = false;
+  std::string sweep_threads;
+  std::string sweep_prefixes;
+  std::string sweep_algorithms;
+
 private:
+  lce_candidate auto_choice;
+
+  /* The measurements of one configuration of --sweep */
+  struct sweep_point {
+    size_t threads;
+    size_t size;
+    size_t queries;
+    double construction_ms;
+    double queries_ms;
+    size_t wrong_queries;
+  };
+
+  /* Writes the text of a generator spec (see text_generator.hpp) to the
+     output path, unless it is there already, and returns its path. The
+     other options then work as for a text file, e.g., --mmap, --pread, or
+     the queries of genqueries for the file. */
+  std::string generated_text(std::string const& spec) const {
+    std::string name = "gen_" + spec;
+    std::replace_if(name.begin(), name.end(), [](char const c) {
+      return c == ':' || c == ',' || c == '=' || c == '/';
+    }, '_');
+    fs::path const path = fs::path{output_path} / name;
+    if (!fs::exists(path)) {
+      fs::create_directories(output_path);
+      std::vector<uint8_t> const text = textgen::generate(spec);
+      // A text that was not written completely must not be used by later runs.
+      fs::path const tmp_path = path.string() + ".tmp" + std::to_string(::getpid());
+      {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<char const*>(text.data()), text.size());
+        out.close();
+        if (!out) {
+          fs::remove(tmp_path);
+          throw std::runtime_error("Cannot write " + tmp_path.string());
+        }
+      }
+      fs::rename(tmp_path, path);
+    }
+    std::cout << "RESULT algo=gentext spec=" << spec << " "
+              << "input=" << path.string() << " "
+              << "size=" << fs::file_size(path) << std::endl;
+    return path;
+  }
+
+  /* Splits a comma separated list. */
+  static std::vector<std::string> split_list(std::string const& list) {
+    std::vector<std::string> result;
+    std::istringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+      if (!item.empty()) {
+        result.push_back(item);
+      }
+    }
+    return result;
+  }
+
+  /* Loads the text once and measures the construction and the queries of
+     every algorithm of --algorithms with every thread count of --threads,
+     on every prefix of --prefixes (strong scaling) and on a prefix that grows
+     with the number of threads (weak scaling). With the most threads, weak
+     scaling uses the largest prefix. Prefixes shorter than 3 * tau are
+     skipped (strong scaling) or extended to 3 * tau (weak scaling). */
+  void run_sweep() {
+#ifdef ALLOW_PARALLEL
+    text_file const text = mmap_text ? map_text(file_path, prefix_length, huge_pages)
+                                     : text_file(load_text(file_path, prefix_length));
+    int const max_threads = omp_get_max_threads();
+
+    std::vector<size_t> threads;
+    for (auto const& t : split_list(sweep_threads)) {
+      threads.push_back(std::max<size_t>(std::stoull(t), 1));
+    }
+    if (threads.empty()) {
+      for (int t = 1; t < max_threads; t *= 2) {
+        threads.push_back(t);
+      }
+      threads.push_back(max_threads);
+    }
+    std::sort(threads.begin(), threads.end());
+
+    std::vector<size_t> prefixes;
+    for (auto const& p : split_list(sweep_prefixes)) {
+      uint64_t size;
+      if (!tlx::parse_si_iec_units(p, &size)) {
+        throw std::runtime_error("Invalid prefix size " + p);
+      }
+      prefixes.push_back(std::min<uint64_t>(size, text.size()));
+    }
+    if (prefixes.empty()) {
+      prefixes.push_back(text.size());
+    }
+    size_t const largest = *std::max_element(prefixes.begin(), prefixes.end());
+
+    for (auto const& algo : split_list(sweep_algorithms.empty() ? algorithm : sweep_algorithms)) {
+      algorithm = algo;
+      size_t const min_size = min_sweep_size();
+      if (text.size() < min_size) {
+        throw std::runtime_error("--sweep with " + algorithm + " needs a text of at least " +
+                                 std::to_string(min_size) + " bytes");
+      }
+      for (size_t const size : prefixes) {
+        if (size < min_size) {
+          std::cout << "# skipped the prefix of " << size << " bytes, which is too short for "
+                    << print_algo_name() << " (at least " << min_size << " bytes)" << std::endl;
+          continue;
+        }
+        std::vector<sweep_point> points;
+        for (size_t const p : threads) {
+          points.push_back(measure_sweep(text.span().first(size), p, number_lce_queries));
+        }
+        print_scaling("strong", points);
+      }
+      std::vector<sweep_point> points;
+      for (size_t const p : threads) {
+        // Few threads on a short largest prefix would get too short prefixes.
+        size_t const size = std::max(largest * p / threads.back(), min_size);
+        size_t const queries = std::max<size_t>(number_lce_queries * p / threads.back(), 1);
+        points.push_back(measure_sweep(text.span().first(size), p, queries));
+      }
+      print_scaling("weak", points);
+    }
+    omp_set_num_threads(max_threads);
+#else
+    throw std::runtime_error("--sweep needs a build with ALLOW_PARALLEL");
+#endif
+  }
+
+#ifdef ALLOW_PARALLEL
+  /* Builds the data structure of the parallel string synchronizing set
+     algorithm on the text and answers random queries with all threads. */
+  sweep_point measure_sweep(std::span<uint8_t const> const text, size_t const threads,
+                            size_t const num_queries) {
+    omp_set_num_threads(threads);
+    lce_test::execution::openmp const exec(threads);
+    std::vector<uint64_t> const queries = workload::random_queries(text.size(), num_queries, seed);
+    std::vector<uint64_t> results(num_queries);
+    tlx::Aggregate<double> construction_times;
+    tlx::Aggregate<double> queries_times;
+    timer t;
+    for (size_t i = 0; i < runs; ++i) {
+      std::unique_ptr<LceDataStructure> lce;
+      t.reset();
+      lce = make_parallel_sss(text);
+      construction_times.add(t.get_ns() / 1e6);
+
+      t.reset();
+      lce_test::execution::parallel_for(exec, num_queries, [&](size_t const k) {
+        results[k] = lce->lce(queries[2 * k], queries[2 * k + 1]);
+      });
+      queries_times.add(t.get_ns() / 1e6);
+    }
+
+    size_t wrong = 0;
+    if (check) {
+      LceUltraNaive lce_naive(text);
+      for (size_t k = 0; k < num_queries; ++k) {
+        wrong += (results[k] != lce_naive.lce(queries[2 * k], queries[2 * k + 1]));
+      }
+    }
+    return {threads, text.size(), num_queries, construction_times.avg(), queries_times.avg(), wrong};
+  }
+
+  /* The shortest text for which the data structure of algorithm can be
+     built, i.e., 3 * tau. */
+  size_t min_sweep_size() const {
+    std::string const sss = algorithm.substr(0, algorithm.find('_'));
+    size_t tau = 512;
+    for (size_t const t : {256, 1024, 2048}) {
+      if (sss == "s" + std::to_string(t)) {
+        tau = t;
+      }
+    }
+    return 3 * tau;
+  }
+
+  std::unique_ptr<LceDataStructure> make_parallel_sss(std::span<uint8_t const> const text) {
+    using lce_test::execution::default_policy;
+    bool const hierarchical = algorithm.ends_with("_hier");
+    std::string const sss = algorithm.substr(0, algorithm.find('_'));
+    if (!hierarchical && !algorithm.ends_with("_par")) {
+      throw std::runtime_error("--sweep needs parallel [s]tring synchronizing sets, not " + algorithm);
+    } else if (sss == "s2048") {
+      return hierarchical ? build_sss<2048, default_policy, true>(text, false)
+                          : build_sss<2048, default_policy, false>(text, false);
+    } else if (sss == "s1024") {
+      return hierarchical ? build_sss<1024, default_policy, true>(text, false)
+                          : build_sss<1024, default_policy, false>(text, false);
+    } else if (sss == "s512" || sss == "s") {
+      return hierarchical ? build_sss<512, default_policy, true>(text, false)
+                          : build_sss<512, default_policy, false>(text, false);
+    } else if (sss == "s256") {
+      return hierarchical ? build_sss<256, default_policy, true>(text, false)
+                          : build_sss<256, default_policy, false>(text, false);
+    }
+    throw std::runtime_error("Unknown algorithm " + algorithm);
+  }
+
+  /* Prints a RESULT line for every point and a table of the scaling. The
+     speedup and the efficiency compare the work per time (bytes of text for
+     the construction, queries for the queries) with the first point, so the
+     speedup of weak scaling is the scaled speedup. */
+  void print_scaling(std::string const& scaling, std::vector<sweep_point> const& points) {
+    sweep_point const& base = points.front();
+    auto speedup = [&](double const work, double const ms, double const base_work,
+                       double const base_ms) {
+      return (ms > 0 && base_work > 0) ? (work / ms) / (base_work / base_ms) : 0.0;
+    };
+
+    std::ostringstream table;
+    table << "# " << scaling << " scaling of " << print_algo_name() << " on "
+          << (scaling == "weak" ? "a prefix growing with the threads up to " : "")
+          << points.back().size << " bytes of " << file_path << "\n"
+          << "# " << std::setw(7) << "threads" << std::setw(12) << "size"
+          << std::setw(18) << "construction_ms" << std::setw(9) << "speedup"
+          << std::setw(11) << "efficiency" << std::setw(14) << "ns_per_query"
+          << std::setw(9) << "speedup" << std::setw(11) << "efficiency" << "\n";
+    for (auto const& point : points) {
+      double const construction_speedup = speedup(point.size, point.construction_ms, base.size,
+                                                  base.construction_ms);
+      double const queries_speedup = speedup(point.queries, point.queries_ms, base.queries,
+                                             base.queries_ms);
+      double const threads_ratio = double(point.threads) / base.threads;
+      double const ns_per_query = point.queries_ms * 1e6 / point.queries;
+      std::cout << "RESULT "
+                << "algo=" << print_algo_name() << "_sweep "
+                << "scaling=" << scaling << " "
+                << "runs=" << runs << " "
+                << "threads=" << point.threads << " "
+                << "input=" << file_path << " "
+                << "size=" << point.size << " "
+                << "construction_time=" << point.construction_ms << " "
+                << "construction_speedup=" << construction_speedup << " "
+                << "construction_efficiency=" << construction_speedup / threads_ratio << " "
+                << "queries=" << point.queries << " "
+                << "queries_time=" << point.queries_ms << " "
+                << "ns_per_query=" << ns_per_query << " "
+                << "queries_speedup=" << queries_speedup << " "
+                << "queries_efficiency=" << queries_speedup / threads_ratio << " "
+                << "check="
+                << (check ? (point.wrong_queries == 0 ? "passed" :
+                             ("failed(" + std::to_string(point.wrong_queries) + ")")) : "none")
+                << std::endl;
+      table << "# " << std::fixed << std::setprecision(2)
+            << std::setw(7) << point.threads << std::setw(12) << point.size
+            << std::setw(18) << point.construction_ms << std::setw(9) << construction_speedup
+            << std::setw(11) << construction_speedup / threads_ratio
+            << std::setw(14) << ns_per_query << std::setw(9) << queries_speedup
+            << std::setw(11) << queries_speedup / threads_ratio << "\n";
+    }
+    std::cout << table.str() << std::flush;
+  }
+#endif
+
+  /* Builds the string synchronizing set LCE data structure. With --pread,
+     it reads the text itself while it builds the set. */
+  template <uint64_t kTau, typename Exec, bool hierarchical = false>
+  std::unique_ptr<LceDataStructure> make_sss(text_file const& text, bool const print_ss_size) {
+    if (parallel_load) {
+      lce_test::pread_file const file(file_path, prefix_length);
+      return build_sss<kTau, Exec, hierarchical>(file, print_ss_size);
+    }
+    return build_sss<kTau, Exec, hierarchical>(text.span(), print_ss_size);
+  }
+
+  /* Builds the string synchronizing set LCE data structure with the query
+     mode that is selected with --long and --adaptive. */
+  template <uint64_t kTau, typename Exec, bool hierarchical, typename Text>
+  std::unique_ptr<LceDataStructure> build_sss(Text const& text, bool const print_ss_size) {
+    using lce_test::par::LceSemiSyncSetsPar;
+    using lce_test::par::query_mode;
+    if (adaptive_queries) {
+      return std::make_unique<LceSemiSyncSetsPar<kTau, query_mode::adaptive, Exec, hierarchical>>(text, print_ss_size);
+    } else if (prefer_long_queries) {
+      return std::make_unique<LceSemiSyncSetsPar<kTau, query_mode::successor_first, Exec, hierarchical>>(text, print_ss_size);
+    }
+    return std::make_unique<LceSemiSyncSetsPar<kTau, query_mode::scan_first, Exec, hierarchical>>(text, print_ss_size);
+  }
+
+  /* Reads the text or, with --mmap, maps it. With --pread, the string
+     synchronizing sets read the text during their construction. */
+  text_file open_text(fs::path const& text_path) const {
+    if ((parallel_load || external) && uses_sss()) {
+      return text_file();
+    }
+    if (mmap_text) {
+      return map_text(text_path, prefix_length, huge_pages);
+    }
+    return text_file(load_text(text_path, prefix_length));
+  }
+
+  bool uses_sss() const {
+    return algorithm.starts_with("s") && algorithm != "sada" && algorithm != "sct3";
+  }
+
+  /* Maps a string synchronizing set LCE data structure with the query mode
+     that is selected with --long and --adaptive. */
+  template <uint64_t kTau, bool hierarchical>
+  std::unique_ptr<LceDataStructure> open_sss(std::string const& path,
+                                             lce_test::serialization::map_options const& opt) const {
+    using lce_test::execution::default_policy;
+    using lce_test::par::LceSemiSyncSetsPar;
+    using lce_test::par::query_mode;
+    if (adaptive_queries) {
+      return open_sss<LceSemiSyncSetsPar<kTau, query_mode::adaptive, default_policy, hierarchical>>(path, opt);
+    } else if (prefer_long_queries) {
+      return open_sss<LceSemiSyncSetsPar<kTau, query_mode::successor_first, default_policy, hierarchical>>(path, opt);
+    }
+    return open_sss<LceSemiSyncSetsPar<kTau, query_mode::scan_first, default_policy, hierarchical>>(path, opt);
+  }
+
+  template <typename Lce>
+  std::unique_ptr<LceDataStructure> open_sss(std::string const& path,
+                                             lce_test::serialization::map_options const& opt) const {
+    if (semi_external) {
+      return Lce::open_semi_external(path);
+    }
+    return Lce::open_mmap(path, opt);
+  }
+
+#ifdef ALLOW_PARALLEL
+  /* Builds the string synchronizing set LCE data structure with at most
+     --ram bytes of memory and writes it to the file of --save. */
+  void build_external(fs::path const& text_path) const {
+    lce_test::par::external_options opt;
+    opt.ram_budget = ram_budget;
+    opt.tmp_dir = tmp_dir;
+    opt.prefix_size = prefix_length;
+    bool const hierarchical = algorithm.ends_with("_hier");
+    std::string const sss = algorithm.substr(0, algorithm.find('_'));
+    if (sss == "s2048") {
+      build_external<2048>(text_path, opt, hierarchical);
+    } else if (sss == "s1024") {
+      build_external<1024>(text_path, opt, hierarchical);
+    } else if (sss == "s512" || sss == "s") {
+      build_external<512>(text_path, opt, hierarchical);
+    } else if (sss == "s256") {
+      build_external<256>(text_path, opt, hierarchical);
+    } else {
+      throw std::runtime_error("Cannot build algorithm " + algorithm + " externally");
+    }
+  }
+
+  template <uint64_t kTau>
+  void build_external(fs::path const& text_path, lce_test::par::external_options const& opt,
+                      bool const hierarchical) const {
+    using lce_test::par::LceSemiSyncSetsExternal;
+    if (hierarchical) {
+      LceSemiSyncSetsExternal<kTau, true>::build(text_path, save_path, opt);
+    } else {
+      LceSemiSyncSetsExternal<kTau, false>::build(text_path, save_path, opt);
+    }
+  }
+#endif
+
+  /* Maps the data structure that was stored with --save instead of
+     building it. The file contains the text, too. */
+  std::unique_ptr<LceDataStructure> open_index(std::string const& path) const {
+    lce_test::serialization::map_options opt;
+    opt.populate = populate;
+    // The execution policy does not change the layout, so _par is the same.
+    bool const hierarchical = algorithm.ends_with("_hier");
+    std::string const sss = algorithm.substr(0, algorithm.find('_'));
+    if (algorithm == "u") {
+      return LceUltraNaive::open_mmap(path, opt);
+    } else if (algorithm == "n") {
+      return LceNaive::open_mmap(path, opt);
+    } else if (algorithm == "p") {
+      return LcePrezza<128>::open_mmap(path, opt);
+    } else if (sss == "s2048") {
+      return hierarchical ? open_sss<2048, true>(path, opt) : open_sss<2048, false>(path, opt);
+    } else if (sss == "s1024") {
+      return hierarchical ? open_sss<1024, true>(path, opt) : open_sss<1024, false>(path, opt);
+    } else if (sss == "s512" || sss == "s") {
+      return hierarchical ? open_sss<512, true>(path, opt) : open_sss<512, false>(path, opt);
+    } else if (sss == "s256") {
+      return hierarchical ? open_sss<256, true>(path, opt) : open_sss<256, false>(path, opt);
+    }
+    throw std::runtime_error("Cannot load algorithm " + algorithm);
+  }
+
+  /* Predicts the costs of all data structures for the text and the queries
+     in [lce_from, lce_to) and picks the cheapest one. */
+  template <typename lce_files>
+  void choose_algorithm(fs::path const& text_path, fs::path const& lce_path,
+                        lce_files const& lce_set) {
+    text_file const text = open_text(text_path);
+    open_query_file(lce_path, text_path, text.size());
+    LceFactory::options opt;
+    opt.memory_budget = memory_budget;
+    opt.expected_queries = number_lce_queries * runs * (lce_to - lce_from);
+    LceFactory factory(text.span(), opt);
+
+    // Random queries need no query files, so missing classes are skipped.
+    for (size_t i = lce_from; i < lce_to; ++i) {
+      if (queries_ || fs::exists(lce_set[i])) {
+        factory.add_query_sample(load_queries(lce_set[i], i, 2048));
+      }
+    }
+
+    std::vector<lce_candidate> const candidates = factory.candidates();
+    for (auto const& c : candidates) {
+      std::cout << "RESULT algo=auto_candidate " << c << " "
+                << "input=" << text_path << " "
+                << "size=" << text.size() << std::endl;
+    }
+    auto_choice = candidates.front();
+  }
+
   std::string print_algo_name() {
     std::string name("unknown");
     if (algorithm == "u") {
@@ -366,13 +1063,25 @@ private:
       name = "sss512_par";
     } else if (algorithm == "s256_par") {
       name = "sss256_par";
+    } else if (algorithm == "s2048_hier") {
+      name = "sss2048_hier";
+    } else if (algorithm == "s1024_hier") {
+      name = "sss1024_hier";
+    } else if (algorithm == "s512_hier" || algorithm == "s_hier") {
+      name = "sss512_hier";
+    } else if (algorithm == "s256_hier") {
+      name = "sss256_hier";
+    } else if (algorithm == "auto") {
+      name = "auto_" + auto_choice.name + (auto_choice.prefer_long ? "pl" : "");
     } else if (algorithm == "sada") {
       name = "sdsl_sada";
     } else if (algorithm == "sct3") {
       name = "sdsl_sct3";
     }
 
-    if (name.rfind("sss", 0) == 0 && prefer_long_queries) {
+    if (name.rfind("sss", 0) == 0 && adaptive_queries) {
+      name.append("_adaptive");
+    } else if (name.rfind("sss", 0) == 0 && prefer_long_queries) {
       name.append("pl");
     }
 
@@ -391,7 +1100,9 @@ int32_t main(int argc, char *argv[]) {
                 "        Florian Kurpicz  <florian.kurpicz@tu-dortmund.de>\n"
                 "        Patrick Dinklage <patrick.dinklage@tu-dortmund.de>");
 
-  cp.add_param_string("file", lce_bench.file_path, "The text which is queried");
+  cp.add_param_string("file", lce_bench.file_path, "The text which is "
+                      "queried or gen:<spec> for a synthetic text, e.g., "
+                      "gen:fibonacci:n=64Mi (see gentext).");
   cp.add_string('o', "output_path", lce_bench.output_path, "Path where LCE "
                 "queries are stored (default: /tmp/res_lce).");
   cp.add_bytes('p', "pre", lce_bench.prefix_length, "Size of the prefix in "
@@ -400,16 +1111,88 @@ int32_t main(int argc, char *argv[]) {
                 "that is computed: [u]ltra naive (default), [n]aive, "
                 "prezza [m]ersenne, [p]rezza, or [s]tring synchronizing sets "
                 "with tau = 512. [s2048], [s1024], [s512], [s256] for different "
-                "tau values. Suffix _par for parallel sss, e.g. [s256_par]");
+                "tau values. Suffix _par for parallel sss, e.g. [s256_par], "
+                "suffix _hier for hierarchical sss, e.g. [s256_hier]. [auto] "
+                "predicts the costs of all of them and picks the fastest.");
   cp.add_flag('l', "long", lce_bench.prefer_long_queries, "Prefer long queries,"
               " i.e., queries with long LCE get faster, all other get slower. "
               "Only for [s]tring synchronizing sets.");
+  cp.add_bytes('b', "budget", lce_bench.memory_budget, "Memory budget of "
+               "[auto] for the construction (optional).");
+  cp.add_flag("adaptive", lce_bench.adaptive_queries, "Switch between the "
+              "query modes of --long at runtime, depending on the share of "
+              "long queries. Only for [s]tring synchronizing sets.");
+  cp.add_flag("mmap", lce_bench.mmap_text, "Memory map the text instead of "
+              "reading it. [p]rezza still copies it, because it works "
+              "in-place.");
+  cp.add_flag("pread", lce_bench.parallel_load, "Let [s]tring synchronizing "
+              "sets read the text in parallel while they are built, "
+              "instead of reading it before.");
+  cp.add_flag("huge_pages", lce_bench.huge_pages, "Ask for transparent huge "
+              "pages for the text of --mmap.");
+  cp.add_string("save", lce_bench.save_path, "Store the data structure of "
+                "the first run in this file (optional).");
+  cp.add_string("load", lce_bench.load_path, "Memory map the data structure "
+                "from a file written with --save instead of building it. "
+                "Not for [m]ersenne and [auto] (optional).");
+  cp.add_flag("populate", lce_bench.populate, "Read the whole file of --load "
+              "when it is mapped instead of on demand.");
+  cp.add_flag("semi_external", lce_bench.semi_external, "Keep the text of "
+              "--load on disk and report the I/O per query. Only for "
+              "[s]tring synchronizing sets.");
+  cp.add_flag("external", lce_bench.external, "Build [s]tring synchronizing "
+              "sets in external memory into the file of --save and map it "
+              "from there. Not for texts with long runs.");
+  cp.add_bytes("ram", lce_bench.ram_budget, "Memory budget of --external "
+               "(default=1GiB).");
+  cp.add_string("tmp", lce_bench.tmp_dir, "Directory for the temporary "
+                "files of --external (default=/tmp).");
+  cp.add_string("record", lce_bench.record_path, "Write all LCE queries to "
+                "this trace for bench_replay (optional). A query takes 32 "
+                "bytes.");
+  cp.add_string("phases", lce_bench.phases_path, "Write the time, CPU time "
+                "and memory of the construction phases as JSON to this file "
+                "(optional).");
+  cp.add_string("trace", lce_bench.trace_path, "Write the spans of all "
+                "threads during the first construction to this file as Chrome "
+                "trace JSON, e.g., for ui.perfetto.dev (optional).");
+  cp.add_flag("sweep", lce_bench.sweep, "Load the text once and measure "
+              "the strong and weak scaling of the construction and of "
+              "random queries answered by all threads. Only for parallel "
+              "[s]tring synchronizing sets.");
+  cp.add_string("threads", lce_bench.sweep_threads, "Comma separated thread "
+                "counts of --sweep (default: powers of two up to all "
+                "threads).");
+  cp.add_string("prefixes", lce_bench.sweep_prefixes, "Comma separated "
+                "prefix sizes of --sweep, e.g., 64Mi,256Mi (default: the "
+                "text).");
+  cp.add_string("algorithms", lce_bench.sweep_algorithms, "Comma separated "
+                "algorithms of --sweep (default: --algorithm).");
   cp.add_flag('c', "check", lce_bench.check, "Check correctness of LCE queries "
               "by comparing with results of naive computation.");
   cp.add_bytes('q', "queries", lce_bench.number_lce_queries, "Number of LCE "
               "queries that are executed (default=1,000,000).");
+  cp.add_size_t("sample", lce_bench.sample_every, "Measure the latency of "
+                "every k-th query on its own after the throughput runs for the "
+                "latency percentiles (default=16, 0 to measure none).");
+  cp.add_flag("perf", lce_bench.perf, "Count cycles, instructions, cache, "
+              "TLB and branch misses of the construction and the queries "
+              "with hardware performance counters, if they are available.");
   cp.add_uint('r', "runs", lce_bench.runs, "Number of runs that are used to "
               "report an average running time (default=5).");
+  cp.add_string('m', "mode", lce_bench.query_mode, "Query workload: "
+                "[sorted] runs the queries of each length class of --from "
+                "and --to on their own (default), [random] uniform position "
+                "pairs, [zipf] pairs of skewed hot positions, and [mixed] "
+                "interleaves the queries of the length classes in one "
+                "stream.");
+  cp.add_size_t("seed", lce_bench.seed, "Seed of the [random], [zipf] and "
+                "[mixed] queries (default=1).");
+  cp.add_double("zipf", lce_bench.zipf_s, "Exponent of [zipf], larger "
+                "values give fewer hot positions (default=1).");
+  cp.add_string("mix", lce_bench.mix, "Comma separated weights of the "
+                "length classes from --from on for [mixed] (default: all "
+                "classes with queries are equally likely).");
   cp.add_uint("from", lce_bench.lce_from, "Use only lce "
               "queries which return at least 2^{from} (optional).");
   cp.add_uint("to", lce_bench.lce_to, "Use only lce queries "
@@ -13,9 +13,17 @@
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <random>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 #include <tlx/cmdline_parser.hpp>
+#include <src/libsais64.h>
+
+#include "util/execution.hpp"
+#include "util/query_file.hpp"
+#include "util/serialization.hpp"
 
 #include <unistd.h>
 #include <fcntl.h>
@@ -31,6 +39,10 @@ struct {
   size_t limit = 100'000;
   size_t bufsize = 1024 * 1024;
   bool show_progress = false;
+  bool binary = false;
+  bool convert = false;
+  bool build = false;
+  size_t seed = 1;
 } options;
 
 class BufferedReader {
@@ -86,6 +98,180 @@ void print_counts(It begin, It end) {
   std::cout << std::endl;
 }
 
+/* Name of the binary query file in the output directory */
+std::string const binary_name = "lce_queries.bin";
+
+uint64_t hash_text_file(std::string const& path) {
+  lce_test::serialization::map_options opt;
+  opt.sequential = true;
+  lce_test::serialization::mapped_file const text(path, opt);
+  return lce_test::query_file::hash_text(std::span<uint8_t const>(text.data(), text.size()));
+}
+
+/* Converts the lce_* files of the output directory to a binary query file. */
+int convert_queries() {
+  std::array<std::vector<uint64_t>, lce_test::query_file::kNumClasses> positions;
+  for(size_t x = 0; x < positions.size(); x++) {
+    auto const infile = std::filesystem::path(options.out_dir) /
+                        ("lce_" + std::to_string(x));
+    std::ifstream in(infile);
+    if(!in) {
+      std::cerr << "file not found: " << infile << std::endl;
+      return -1;
+    }
+    for(uint64_t pos; in >> pos;) {
+      positions[x].push_back(pos);
+    }
+  }
+
+  size_t const n = std::filesystem::file_size(options.file_text);
+  auto const outfile = std::filesystem::path(options.out_dir) / binary_name;
+  lce_test::query_file::write(outfile, n, hash_text_file(options.file_text), positions);
+  std::cout << "Converted the queries of \"" << options.out_dir << "\" to "
+            << outfile << std::endl;
+  return 0;
+}
+
+using query_positions =
+  std::array<std::vector<uint64_t>, lce_test::query_file::kNumClasses>;
+
+/* Writes the queries to the lce_* files or, with --binary, to one file. */
+void write_queries(query_positions const& positions, size_t const n) {
+  if(options.binary) {
+    auto const outfile = std::filesystem::path(options.out_dir) / binary_name;
+    lce_test::query_file::write(outfile, n, hash_text_file(options.file_text),
+                                positions);
+    return;
+  }
+  for(size_t x = 0; x < positions.size(); x++) {
+    auto const outfile = std::filesystem::path(options.out_dir) /
+                         ("lce_" + std::to_string(x));
+    std::ofstream out(outfile);
+    for(auto const pos : positions[x]) {
+      out << pos << "\n";
+    }
+  }
+}
+
+/* Returns m distinct numbers of [0, N) in increasing order, chosen
+   uniformly at random (Floyd's algorithm). */
+std::vector<uint64_t> sample_ranks(uint64_t const N, uint64_t const m,
+                                   std::mt19937_64& gen) {
+  std::vector<uint64_t> result;
+  if(m >= N) {
+    result.resize(N);
+    for(uint64_t k = 0; k < N; k++) result[k] = k;
+    return result;
+  }
+  std::unordered_set<uint64_t> chosen;
+  for(uint64_t j = N - m; j < N; j++) {
+    uint64_t const r = std::uniform_int_distribution<uint64_t>(0, j)(gen);
+    chosen.insert(chosen.contains(r) ? j : r);
+  }
+  result.assign(chosen.begin(), chosen.end());
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+/* Builds the suffix and LCP array in memory and samples up to limit
+   queries of every length class uniformly from all SA neighbors of the
+   class. The first scan counts the neighbors per class and thread. Then we
+   draw the ranks of the sampled neighbors, and the second scan picks
+   them. Both scans run in parallel. Needs 16 bytes per character. */
+int build_queries() {
+  lce_test::serialization::mapped_file const text(options.file_text);
+  int64_t const n = text.size();
+  if(n < 2 || n >= (int64_t{1} << 40)) {
+    std::cerr << "--build needs a text with 2 to 2^40 characters" << std::endl;
+    return -1;
+  }
+
+  lce_test::execution::default_policy const exec;
+  std::vector<int64_t> sa(n);
+  std::vector<int64_t> lcp(n);
+  {
+#ifdef LIBSAIS_OPENMP
+    int32_t const threads = exec.num_threads();
+    bool failed = libsais64_omp(text.data(), sa.data(), n, 0, nullptr, threads) != 0;
+    failed = failed || libsais64_plcp_omp(text.data(), sa.data(), lcp.data(), n, threads) != 0;
+#else
+    bool failed = libsais64(text.data(), sa.data(), n, 0, nullptr) != 0;
+    failed = failed || libsais64_plcp(text.data(), sa.data(), lcp.data(), n) != 0;
+#endif
+    if(failed) {
+      std::cerr << "libsais failed" << std::endl;
+      return -1;
+    }
+    // lcp holds the PLCP array, i.e., the LCP values in text order. The
+    // classes only need the LCP up to 2^20, so it fits above the 40 bits of
+    // the suffix and the scans need no random accesses.
+    lce_test::execution::parallel_for(exec, n, [&](size_t const i) {
+      sa[i] |= std::min<int64_t>(lcp[sa[i]], int64_t{1} << 20) << 40;
+    });
+  }
+  auto const sa_at = [&](size_t const i) {
+    return uint64_t(sa[i]) & ((uint64_t{1} << 40) - 1);
+  };
+  auto const class_at = [&](size_t const i) {
+    uint64_t const lcp_i = uint64_t(sa[i]) >> 40;
+    return std::min<size_t>(std::bit_width(lcp_i), lce_test::query_file::kNumClasses - 1);
+  };
+  lcp = std::vector<int64_t>();
+
+  size_t constexpr num_classes = lce_test::query_file::kNumClasses;
+  int const nt = exec.num_threads();
+  // count[t][x] is the number of neighbors of class x in block t.
+  std::vector<std::array<uint64_t, num_classes>> count(nt);
+  exec.for_each_block([&](int const t, int const nt) {
+    auto const [begin, end] = lce_test::execution::block_range(n - 1, t, nt);
+    count[t].fill(0);
+    for(size_t i = begin + 1; i < end + 1; i++) {
+      ++count[t][class_at(i)];
+    }
+  });
+
+  std::mt19937_64 gen(options.seed);
+  std::array<std::vector<uint64_t>, num_classes> ranks;
+  std::array<uint64_t, num_classes> total = {};
+  for(size_t x = 0; x < num_classes; x++) {
+    for(int t = 0; t < nt; t++) total[x] += count[t][x];
+    ranks[x] = sample_ranks(total[x], options.limit, gen);
+  }
+
+  query_positions positions;
+  for(size_t x = 0; x < num_classes; x++) {
+    positions[x].resize(2 * ranks[x].size());
+  }
+  exec.for_each_block([&](int const t, int const nt) {
+    auto const [begin, end] = lce_test::execution::block_range(n - 1, t, nt);
+    // Rank of the first neighbor of the block and next sampled rank per class
+    std::array<uint64_t, num_classes> rank = {};
+    std::array<size_t, num_classes> next = {};
+    for(size_t x = 0; x < num_classes; x++) {
+      for(int u = 0; u < t; u++) rank[x] += count[u][x];
+      next[x] = std::lower_bound(ranks[x].begin(), ranks[x].end(), rank[x]) -
+                ranks[x].begin();
+    }
+    for(size_t i = begin + 1; i < end + 1; i++) {
+      size_t const x = class_at(i);
+      if(next[x] < ranks[x].size() && ranks[x][next[x]] == rank[x]) {
+        positions[x][2 * next[x]] = sa_at(i - 1);
+        positions[x][2 * next[x] + 1] = sa_at(i);
+        ++next[x];
+      }
+      ++rank[x];
+    }
+  });
+
+  write_queries(positions, n);
+  std::cout << "Done:" << std::endl;
+  for(size_t x = 0; x < num_classes; x++) {
+    std::cout << "\tQueries for LCP < 2^" << x << ": "
+              << ranks[x].size() << " of " << total[x] << std::endl;
+  }
+  return 0;
+}
+
 bool cancel = false;
 void on_interrupt(int) {
   std::cerr
@@ -127,10 +313,32 @@ int main(int argc, char** argv) {
     cp.add_bytes('b', "bufsize", options.bufsize,
                  "the size of the SA and LCP read buffers in # of entries "
                  "(default: 1Mi)");
+    cp.add_flag("binary", options.binary,
+                "write the queries to the binary file " + binary_name +
+                " instead of the text files lce_*");
+    cp.add_flag("build", options.build,
+                "build the suffix and LCP array in memory instead of reading "
+                "them, and sample the queries uniformly from all suffix "
+                "array neighbors of each length class");
+    cp.add_size_t("seed", options.seed,
+                  "seed of the sampling of --build (default: 1)");
+    cp.add_flag("convert", options.convert,
+                "convert the lce_* files of the output directory to " +
+                binary_name + " and exit");
     if(!cp.process(argc, argv)) {
       return -1;
     }
 
+    if(options.convert) {
+      return convert_queries();
+    }
+    if(options.build) {
+      std::cout << "Generating LCE queries for \"" << options.file_text
+                << "\" to \"" << options.out_dir << "\" with libsais ..."
+                << std::endl;
+      return build_queries();
+    }
+
     if(options.file_sa.empty()) {
       options.file_sa = options.file_text
                         + ".sa" + std::to_string(options.width);
@@ -186,13 +394,17 @@ int main(int argc, char** argv) {
   BufferedReader lcp(fd_lcp, options.bufsize * options.width);
 
   // open outputs
+  static_assert(max_lcp_exp + 1 == lce_test::query_file::kNumClasses);
   std::array<std::ofstream, max_lcp_exp+1> out;
+  std::array<std::vector<uint64_t>, max_lcp_exp+1> binary_out;
   std::array<size_t, max_lcp_exp+1> count;
   {
     for(size_t x = 0; x <= max_lcp_exp; x++) {
-      auto outfile = std::filesystem::path(options.out_dir) /
-                     ("lce_" + std::to_string(x));
-      out[x] = std::ofstream(outfile);
+      if(!options.binary) {
+        auto outfile = std::filesystem::path(options.out_dir) /
+                       ("lce_" + std::to_string(x));
+        out[x] = std::ofstream(outfile);
+      }
       count[x] = 0;
     }
   }
@@ -228,8 +440,13 @@ int main(int argc, char** argv) {
       ++count[x];
 
       // write query to file
-      out[x] << sa_prev << "\n";
-      out[x] << sa_i << "\n";
+      if(options.binary) {
+        binary_out[x].push_back(sa_prev);
+        binary_out[x].push_back(sa_i);
+      } else {
+        out[x] << sa_prev << "\n";
+        out[x] << sa_i << "\n";
+      }
     }
 
     // keep SA entry
@@ -240,6 +457,12 @@ int main(int argc, char** argv) {
   close(fd_lcp);
   close(fd_sa);
 
+  if(options.binary) {
+    auto const outfile = std::filesystem::path(options.out_dir) / binary_name;
+    lce_test::query_file::write(outfile, n, hash_text_file(options.file_text),
+                                binary_out);
+  }
+
   // result
   std::cout << "Done:" << std::endl;
   for(size_t x = 0; x <= max_lcp_exp; x++) {
@@ -0,0 +1,52 @@
+/*******************************************************************************
+ * benchmark/gentext.cpp
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <tlx/cmdline_parser.hpp>
+
+#include "text_generator.hpp"
+#include "timer.hpp"
+
+int32_t main(int32_t argc, char *argv[]) {
+  std::string spec;
+  std::string output;
+
+  tlx::CmdlineParser cp;
+  cp.set_description("This program writes a synthetic text (see "
+                     "text_generator.hpp). The spec is <kind>:<key>=<value>,... "
+                     "with the kinds uniform (sigma), fibonacci, thue_morse, "
+                     "periodic (period, sigma, mutation), run (char), dna "
+                     "(copies, mutation) and versions (doc, edits). All kinds "
+                     "take the length n (default: 1Mi) and the random ones a "
+                     "seed, e.g., periodic:n=1Gi,period=1,mutation=0.0001.");
+  cp.add_param_string("spec", spec, "The generator and its parameters.");
+  cp.add_param_string("output", output, "The file the text is written to.");
+
+  if (!cp.process(argc, argv)) {
+    std::exit(EXIT_FAILURE);
+  }
+
+  timer t;
+  std::vector<uint8_t> const text = textgen::generate(spec);
+  std::ofstream out(output, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<char const*>(text.data()), text.size());
+  if (!out) {
+    std::cerr << "Cannot write " << output << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+  std::cout << "RESULT spec=" << spec << " "
+            << "output=" << output << " "
+            << "size=" << text.size() << " "
+            << "time=" << t.get() << std::endl;
+  return 0;
+}
+
+/******************************************************************************/
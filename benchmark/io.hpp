@@ -10,9 +10,13 @@
 
 #include <filesystem>
 #include <iostream>
+#include <memory>
+#include <span>
 #include <vector>
 #include <fstream>
 
+#include "util/serialization.hpp"
+
 std::vector<uint8_t> load_text(std::string const& file_path,
                                size_t const prefix_size=0) {
   std::ifstream stream(file_path.c_str(), std::ios::in | std::ios::binary);
@@ -34,5 +38,69 @@ std::vector<uint8_t> load_text(std::string const& file_path,
   return result;
 }
 
+/* A text that is either read into memory or memory mapped. Moving it keeps
+ * the text at its address. */
+class text_file {
+public:
+  text_file() = default;
+
+  explicit text_file(std::vector<uint8_t>&& text) : text_(std::move(text)) { }
+
+  text_file(std::shared_ptr<lce_test::serialization::mapped_file> file,
+            size_t const size)
+    : file_(std::move(file)), size_(size) { }
+
+  std::span<uint8_t const> span() const {
+    if (file_) {
+      return std::span<uint8_t const>(file_->data(), size_);
+    }
+    return std::span<uint8_t const>(text_);
+  }
+
+  operator std::span<uint8_t const>() const {
+    return span();
+  }
+
+  size_t size() const {
+    return file_ ? size_ : text_.size();
+  }
+
+  /* The text as a vector that can be changed. A mapped text is copied. */
+  std::vector<uint8_t>& vector() {
+    if (file_) {
+      text_.assign(file_->data(), file_->data() + size_);
+      file_.reset();
+    }
+    return text_;
+  }
+
+private:
+  std::vector<uint8_t> text_;
+  std::shared_ptr<lce_test::serialization::mapped_file> file_;
+  size_t size_ = 0;
+};
+
+/* Memory maps the text instead of reading it. The pages are read in the
+ * background and stay in the page cache, so several processes can share
+ * them. */
+text_file map_text(std::string const& file_path, size_t const prefix_size=0,
+                   bool const huge_pages=false) {
+  lce_test::serialization::map_options opt;
+  opt.sequential = true;
+  opt.will_need = true;
+  opt.huge_pages = huge_pages;
+  std::shared_ptr<lce_test::serialization::mapped_file> file;
+  try {
+    file = std::make_shared<lce_test::serialization::mapped_file>(file_path, opt);
+  } catch (std::runtime_error const&) {
+    std::cerr << "File " << file_path << " not found" << std::endl;
+    std::exit(-1);
+  }
+  size_t size = file->size();
+  if (prefix_size > 0) {
+    size = std::min(prefix_size, size);
+  }
+  return text_file(std::move(file), size);
+}
 
 /******************************************************************************/
@@ -0,0 +1,377 @@
+/*******************************************************************************
+ * benchmark/lce_server.cpp
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <semaphore>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <tlx/cmdline_parser.hpp>
+
+#include "io.hpp"
+#include "lce_factory.hpp"
+#include "util/lce_interface.hpp"
+#include "util/lce_server_protocol.hpp"
+#include "util/mpmc_queue.hpp"
+
+using namespace lce_test::server;
+
+/* Loads an LCE data structure once and answers the batched queries of other
+ * processes over a Unix domain socket (see util/lce_server_protocol.hpp).
+ *
+ * Every connection has a thread that reads the batches. It splits them into
+ * chunks, which a pool of worker threads takes from a lock-free queue. The
+ * connection thread works on the chunks of its batch, too, until all of them
+ * are answered. A reload builds the new index next to the old one and swaps
+ * them atomically. Batches that are running keep the old one until they are
+ * done. */
+class lce_server {
+public:
+  std::string file_path;
+  std::string socket_path = "/tmp/lce_server.sock";
+  std::string algorithm = "s512";
+  bool prefer_long_queries = false;
+  bool load = false;
+  bool populate = false;
+  uint32_t threads = std::thread::hardware_concurrency();
+  uint32_t chunk_size = 1024;
+
+  void run() {
+    index_.store(open_index(file_path, 0));
+    std::cout << "RESULT "
+              << "algo=" << algorithm << " "
+              << "input=" << file_path << " "
+              << "socket=" << socket_path << " "
+              << "threads=" << threads << std::endl;
+
+    // Only the main thread handles signals.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    int const listen_fd = listen_on(socket_path);
+    for (uint32_t t = 0; t < std::max<uint32_t>(threads, 1); ++t) {
+      std::thread([this] { work(); }).detach();
+    }
+    std::thread([this, listen_fd] { accept_connections(listen_fd); }).detach();
+
+    int signal = 0;
+    sigwait(&signals, &signal);
+    ::close(listen_fd);
+    ::unlink(socket_path.c_str());
+
+    uint64_t const batches = batches_.load();
+    std::cout << "RESULT "
+              << "algo=" << algorithm << "_server "
+              << "batches=" << batches << " "
+              << "queries=" << queries_.load() << " "
+              << "avg_batch_ns=" << (batches > 0 ? total_ns_.load() / batches : 0) << " "
+              << "max_batch_ns=" << max_ns_.load() << " "
+              << "reloads=" << index_.load()->generation << std::endl;
+    // Connections may still be open, so we do not wait for their threads.
+    std::_Exit(EXIT_SUCCESS);
+  }
+
+private:
+  struct served_index {
+    // Empty for data structures that were mapped with --load
+    text_file text;
+    std::unique_ptr<LceDataStructure> lce;
+    uint64_t generation = 0;
+  };
+
+  struct batch {
+    LceDataStructure* lce;
+    op operation;
+    query const* queries;
+    uint64_t* results;
+    std::atomic<size_t> remaining;
+  };
+
+  // The batch lives until its last chunk has notified the connection thread.
+  struct task {
+    std::shared_ptr<batch> b;
+    size_t from = 0;
+    size_t to = 0;
+  };
+
+  std::atomic<std::shared_ptr<served_index>> index_;
+  std::mutex reload_mutex_;
+
+  lce_test::mpmc_queue<task> tasks_{4096};
+  std::counting_semaphore<> pending_{0};
+
+  std::atomic<uint64_t> batches_ = 0;
+  std::atomic<uint64_t> queries_ = 0;
+  std::atomic<uint64_t> total_ns_ = 0;
+  std::atomic<uint64_t> max_ns_ = 0;
+
+  /* Builds the data structure for a text or, with --load, maps a file that
+     was written with --save of bench_time. */
+  std::shared_ptr<served_index> open_index(std::string const& path, uint64_t const generation) const {
+    auto result = std::make_shared<served_index>();
+    result->generation = generation;
+    lce_candidate c;
+    c.name = algorithm;
+    c.prefer_long = prefer_long_queries;
+    if (load) {
+      lce_test::serialization::map_options opt;
+      opt.populate = populate;
+      result->lce = LceFactory::open(c, path, opt);
+      return result;
+    }
+    result->text = map_text(path);
+    if (algorithm == "auto") {
+      c = LceFactory(result->text.span()).best();
+    }
+    if (c.name == "p") {
+      result->lce = LceFactory::build(c, result->text.vector());
+    } else {
+      result->lce = LceFactory::build(c, result->text.span());
+    }
+    return result;
+  }
+
+  static int listen_on(std::string const& path) {
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+      throw std::invalid_argument("The socket path is too long");
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    ::unlink(path.c_str());
+    int const fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::bind(fd, reinterpret_cast<sockaddr const*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(fd, SOMAXCONN) != 0) {
+      throw std::runtime_error("Cannot listen on " + path);
+    }
+    return fd;
+  }
+
+  void accept_connections(int const listen_fd) {
+    while (true) {
+      int const fd = ::accept(listen_fd, nullptr, nullptr);
+      if (fd < 0) {
+        if (errno == EINTR || errno == ECONNABORTED) {
+          continue;
+        }
+        return;
+      }
+      std::thread([this, fd] { serve(fd); }).detach();
+    }
+  }
+
+  void work() {
+    while (true) {
+      pending_.acquire();
+      // The chunk may have been taken by the thread of its connection.
+      if (std::optional<task> const t = tasks_.try_pop()) {
+        run_task(*t);
+      }
+    }
+  }
+
+  static void run_task(task const& t) {
+    batch& b = *t.b;
+    switch (b.operation) {
+      case op::lce:
+        for (size_t k = t.from; k < t.to; ++k) {
+          b.results[k] = b.lce->lce(b.queries[k].i, b.queries[k].j);
+        }
+        break;
+      case op::compare:
+        for (size_t k = t.from; k < t.to; ++k) {
+          b.results[k] = is_smaller_suffix(*b.lce, b.queries[k].i, b.queries[k].j);
+        }
+        break;
+      default:
+        for (size_t k = t.from; k < t.to; ++k) {
+          b.results[k] = b.lce->lce_bounded(b.queries[k].i, b.queries[k].j, b.queries[k].bound);
+        }
+    }
+    if (b.remaining.fetch_sub(1) == 1) {
+      b.remaining.notify_all();
+    }
+  }
+
+  /* Not every data structure implements isSmallerSuffix(), so we compare
+     the first mismatching characters. A suffix is smaller than its longer
+     prefixes. */
+  static uint64_t is_smaller_suffix(LceDataStructure& lce, uint64_t const i, uint64_t const j) {
+    uint64_t const n = lce.getSizeInBytes();
+    uint64_t const l = lce.lce(i, j);
+    if (i + l == n || j + l == n) {
+      return i + l == n && i != j;
+    }
+    return static_cast<uint8_t>(lce[i + l]) < static_cast<uint8_t>(lce[j + l]);
+  }
+
+  /* Answers the requests of one connection until it is closed. */
+  void serve(int const fd) {
+    std::vector<query> queries;
+    std::vector<uint64_t> results;
+    request_header request;
+    while (read_all(fd, &request, sizeof(request))) {
+      auto const begin = std::chrono::steady_clock::now();
+      response_header response;
+      bool unknown_operation = false;
+      results.clear();
+      if (request.magic != kMagic || request.count > kMaxBatch) {
+        break;
+      }
+      std::shared_ptr<served_index> index = index_.load();
+      if (request.operation == op::reload) {
+        std::string path(request.count, '\0');
+        if (!read_all(fd, path.data(), path.size())) {
+          break;
+        }
+        index = reload(path);
+        response.result = index ? status::ok : status::failed;
+      } else if (request.operation == op::stats) {
+        results.resize(kNumStats);
+        results[kBatches] = batches_.load();
+        results[kQueries] = queries_.load();
+        results[kTotalNs] = total_ns_.load();
+        results[kMaxNs] = max_ns_.load();
+      } else if (request.operation <= op::bounded) {
+        queries.resize(request.count);
+        if (!read_all(fd, queries.data(), queries.size() * sizeof(query))) {
+          break;
+        }
+        results.resize(request.count);
+        response.result = answer(*index, request.operation, queries, results);
+      } else {
+        // We do not know the payload of an unknown operation, so we cannot
+        // find the next request and close the connection after the reply.
+        response.result = status::bad_request;
+        unknown_operation = true;
+      }
+
+      uint64_t const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - begin).count();
+      response.count = results.size();
+      response.server_ns = ns;
+      response.generation = index ? index->generation : index_.load()->generation;
+      if (!write_all(fd, &response, sizeof(response)) ||
+          !write_all(fd, results.data(), results.size() * sizeof(uint64_t))) {
+        break;
+      }
+      if (unknown_operation) {
+        break;
+      }
+      add_latency(request.count, ns);
+    }
+    ::close(fd);
+  }
+
+  /* Splits the batch into chunks for the workers and helps them. */
+  status answer(served_index& index, op const operation, std::vector<query> const& queries,
+                std::vector<uint64_t>& results) {
+    // getSizeInBytes() is the length of the text.
+    size_t const n = index.lce->getSizeInBytes();
+    for (query const& q : queries) {
+      if (q.i >= n || q.j >= n) {
+        return status::bad_request;
+      }
+    }
+    if (queries.empty()) {
+      return status::ok;
+    }
+    size_t const chunk = std::max<size_t>(chunk_size, 1);
+    size_t const num_chunks = (queries.size() + chunk - 1) / chunk;
+    auto const b = std::make_shared<batch>(index.lce.get(), operation, queries.data(), results.data(),
+                                           num_chunks);
+    for (size_t from = 0; from < queries.size(); from += chunk) {
+      task const t{b, from, std::min(from + chunk, queries.size())};
+      if (tasks_.try_push(t)) {
+        pending_.release();
+      } else {
+        run_task(t);
+      }
+    }
+    size_t remaining;
+    while ((remaining = b->remaining.load()) != 0) {
+      if (std::optional<task> const t = tasks_.try_pop()) {
+        run_task(*t);
+      } else {
+        b->remaining.wait(remaining);
+      }
+    }
+    return status::ok;
+  }
+
+  /* Returns the new index or nullptr if it cannot be opened. */
+  std::shared_ptr<served_index> reload(std::string const& path) {
+    std::lock_guard<std::mutex> lock(reload_mutex_);
+    try {
+      std::shared_ptr<served_index> index = open_index(path, index_.load()->generation + 1);
+      index_.store(index);
+      return index;
+    } catch (std::exception const& e) {
+      std::cerr << "Cannot reload " << path << ": " << e.what() << std::endl;
+      return nullptr;
+    }
+  }
+
+  void add_latency(uint64_t const queries, uint64_t const ns) {
+    batches_.fetch_add(1, std::memory_order_relaxed);
+    queries_.fetch_add(queries, std::memory_order_relaxed);
+    total_ns_.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t max = max_ns_.load(std::memory_order_relaxed);
+    while (ns > max && !max_ns_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) { }
+  }
+};
+
+int32_t main(int32_t argc, char *argv[]) {
+  lce_server server;
+
+  tlx::CmdlineParser cp;
+  cp.set_description("This program loads an LCE data structure once and "
+                     "answers batched LCE queries of other processes over a "
+                     "Unix domain socket until it gets SIGINT or SIGTERM.");
+
+  cp.add_param_string("file", server.file_path, "The text or, with --load, "
+                      "the file written with --save of bench_time.");
+  cp.add_string('s', "socket", server.socket_path, "Path of the socket "
+                "(default: /tmp/lce_server.sock).");
+  cp.add_string('a', "algorithm", server.algorithm, "LCE data structure, "
+                "see bench_time (default: s512). [auto] picks the fastest "
+                "one for the text.");
+  cp.add_flag('l', "long", server.prefer_long_queries, "Prefer long queries. "
+              "Only for [s]tring synchronizing sets.");
+  cp.add_flag("load", server.load, "Memory map the data structure from the "
+              "file instead of building it. Reloads map files, too.");
+  cp.add_flag("populate", server.populate, "Read the whole file of --load "
+              "when it is mapped instead of on demand.");
+  cp.add_uint('t', "threads", server.threads, "Number of worker threads "
+              "(default: number of cores).");
+  cp.add_uint("chunk", server.chunk_size, "Number of queries that a worker "
+              "takes at once (default: 1024).");
+
+  if (!cp.process(argc, argv)) {
+    std::exit(EXIT_FAILURE);
+  }
+
+  server.run();
+  return 0;
+}
+
+/******************************************************************************/
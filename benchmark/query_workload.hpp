@@ -0,0 +1,138 @@
+/*******************************************************************************
+ * benchmark/query_workload.hpp
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+/* Query workloads that are generated in process. All of them return the
+ * positions of the queries as pairs (result[2k], result[2k + 1]), like the
+ * lce_* files of genqueries. */
+namespace workload {
+
+/* Zipf distribution on {1, ..., n} with P(k) ~ k^-s for s > 0, sampled in
+ * constant time with rejection-inversion (Hörmann and Derflinger, 1996). */
+class zipf_distribution {
+public:
+  zipf_distribution(uint64_t const n, double const s)
+    : n_(n), s_(s),
+      h_integral_x1_(h_integral(1.5) - 1),
+      h_integral_n_(h_integral(n + 0.5)),
+      threshold_(2 - h_integral_inverse(h_integral(2.5) - h(2))) {
+    if (n == 0 || s <= 0) {
+      throw std::invalid_argument("Zipf needs n > 0 and s > 0");
+    }
+  }
+
+  template <typename Gen>
+  uint64_t operator()(Gen& gen) const {
+    std::uniform_real_distribution<double> uniform(0, 1);
+    while (true) {
+      double const u = h_integral_n_ + uniform(gen) * (h_integral_x1_ - h_integral_n_);
+      double const x = h_integral_inverse(u);
+      uint64_t const k = std::clamp<double>(std::floor(x + 0.5), 1, n_);
+      if (k - x <= threshold_ || u >= h_integral(k + 0.5) - h(k)) {
+        return k;
+      }
+    }
+  }
+
+private:
+  uint64_t n_;
+  double s_;
+  double h_integral_x1_;
+  double h_integral_n_;
+  double threshold_;
+
+  double h(double const x) const {
+    return std::exp(-s_ * std::log(x));
+  }
+
+  // Integral of h, shifted so that it is smooth at s = 1
+  double h_integral(double const x) const {
+    double const log_x = std::log(x);
+    return expm1_div((1 - s_) * log_x) * log_x;
+  }
+
+  double h_integral_inverse(double const x) const {
+    double const t = std::max(x * (1 - s_), -1.0);
+    return std::exp(log1p_div(t) * x);
+  }
+
+  static double expm1_div(double const x) {
+    return (std::abs(x) > 1e-8) ? std::expm1(x) / x : 1 + x * 0.5 * (1 + x / 3 * (1 + 0.25 * x));
+  }
+
+  static double log1p_div(double const x) {
+    return (std::abs(x) > 1e-8) ? std::log1p(x) / x : 1 - x * (0.5 - x * (1.0 / 3 - 0.25 * x));
+  }
+};
+
+/* Uniform position pairs in [0, n) */
+inline std::vector<uint64_t> random_queries(uint64_t const n, size_t const num_queries,
+                                            uint64_t const seed) {
+  std::mt19937_64 gen(seed);
+  std::uniform_int_distribution<uint64_t> pos(0, n - 1);
+  std::vector<uint64_t> result(2 * num_queries);
+  for (auto& p : result) {
+    p = pos(gen);
+  }
+  return result;
+}
+
+/* Both positions of a pair follow a Zipf distribution with exponent s over
+ * the positions, i.e., a few hot positions are queried very often. The
+ * ranks are scattered over the text with a hash. */
+inline std::vector<uint64_t> zipf_queries(uint64_t const n, size_t const num_queries,
+                                          double const s, uint64_t const seed) {
+  std::mt19937_64 gen(seed);
+  zipf_distribution const zipf(n, s);
+  std::vector<uint64_t> result(2 * num_queries);
+  for (auto& p : result) {
+    // splitmix64 of the rank
+    uint64_t z = zipf(gen) + seed * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    p = (z ^ (z >> 31)) % n;
+  }
+  return result;
+}
+
+/* Interleaves the query pairs of several length classes in one stream. A
+ * query is drawn from class c with probability weights[c] / sum(weights),
+ * and then uniformly from the pairs of the class. Classes without pairs
+ * are skipped. */
+inline std::vector<uint64_t> mixed_queries(std::vector<std::vector<uint64_t>> const& classes,
+                                           std::vector<double> weights, size_t const num_queries,
+                                           uint64_t const seed) {
+  weights.resize(classes.size(), 0);
+  for (size_t c = 0; c < classes.size(); ++c) {
+    if (classes[c].size() < 2) {
+      weights[c] = 0;
+    }
+  }
+  if (std::all_of(weights.begin(), weights.end(), [](double const w) { return w <= 0; })) {
+    return {};
+  }
+  std::mt19937_64 gen(seed);
+  std::discrete_distribution<size_t> pick_class(weights.begin(), weights.end());
+  std::vector<uint64_t> result(2 * num_queries);
+  for (size_t k = 0; k < num_queries; ++k) {
+    auto const& pairs = classes[pick_class(gen)];
+    size_t const pair = std::uniform_int_distribution<size_t>(0, pairs.size() / 2 - 1)(gen);
+    result[2 * k] = pairs[2 * pair];
+    result[2 * k + 1] = pairs[2 * pair + 1];
+  }
+  return result;
+}
+}  // namespace workload
+
+/******************************************************************************/
@@ -0,0 +1,357 @@
+/*******************************************************************************
+ * benchmark/text_generator.hpp
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <tlx/string/parse_si_iec_units.hpp>
+
+/* Synthetic texts for the benchmarks, especially cases that real corpora
+ * rarely contain: highly repetitive words (Fibonacci, Thue-Morse), long runs
+ * (periodic, run), and repetitive collections (dna, versions). All of them
+ * are deterministic for a seed. generate() builds a text from a spec like
+ * "periodic:n=64Mi,period=1,mutation=0.001", which gentext and bench_time
+ * (as "gen:<spec>") accept. */
+namespace textgen {
+
+/* The c-th character of an alphabet of size sigma: lowercase letters for
+ * sigma <= 26 and the bytes 1, ..., sigma otherwise. */
+inline uint8_t symbol(size_t const c, size_t const sigma) {
+  return (sigma <= 26) ? 'a' + c : 1 + c;
+}
+
+/* Calls f(i) for the positions i in [0, n) that are hit with probability
+ * rate each. The gaps are geometric, so this is fast for small rates. */
+template <typename F>
+void for_each_hit(size_t const n, double const rate, std::mt19937_64& gen, F&& f) {
+  if (rate <= 0) {
+    return;
+  }
+  if (rate >= 1) {
+    for (size_t i = 0; i < n; ++i) {
+      f(i);
+    }
+    return;
+  }
+  std::geometric_distribution<size_t> gap(rate);
+  for (size_t i = gap(gen); i < n; i += 1 + gap(gen)) {
+    f(i);
+  }
+}
+
+/* Uniform random text over sigma characters */
+inline std::vector<uint8_t> uniform(size_t const n, size_t const sigma, uint64_t const seed) {
+  if (sigma == 0 || sigma > 255) {
+    throw std::invalid_argument("The alphabet size must be in [1, 255]");
+  }
+  std::mt19937_64 gen(seed);
+  std::uniform_int_distribution<size_t> c(0, sigma - 1);
+  std::vector<uint8_t> text(n);
+  for (auto& t : text) {
+    t = symbol(c(gen), sigma);
+  }
+  return text;
+}
+
+/* The prefix of length n of the Fibonacci word over {a, b}, i.e., of the
+ * limit of f_1 = a, f_2 = ab, f_k = f_{k-1} f_{k-2} */
+inline std::vector<uint8_t> fibonacci(size_t const n) {
+  std::vector<uint8_t> text{'a', 'b'};
+  size_t prev_length = 1;
+  while (text.size() < n) {
+    // f_{k-2} is a prefix of f_{k-1}.
+    size_t const length = text.size();
+    text.resize(length + prev_length);
+    std::copy_n(text.begin(), prev_length, text.begin() + length);
+    prev_length = length;
+  }
+  text.resize(n);
+  return text;
+}
+
+/* The prefix of length n of the Thue-Morse word over {a, b} */
+inline std::vector<uint8_t> thue_morse(size_t const n) {
+  std::vector<uint8_t> text(n);
+  for (size_t i = 0; i < n; ++i) {
+    text[i] = 'a' + (std::popcount(i) & 1);
+  }
+  return text;
+}
+
+/* Replaces each character with probability rate by another character of
+ * the alphabet. */
+inline void mutate(std::vector<uint8_t>& text, size_t const sigma, double const rate,
+                   std::mt19937_64& gen) {
+  if (sigma < 2) {
+    return;
+  }
+  std::uniform_int_distribution<size_t> shift(1, sigma - 1);
+  size_t const first = symbol(0, sigma);
+  for_each_hit(text.size(), rate, gen, [&](size_t const i) {
+    text[i] = symbol((text[i] - first + shift(gen)) % sigma, sigma);
+  });
+}
+
+/* A random string of length period over sigma characters, repeated up to
+ * length n. Each character is mutated with probability mutation. period = 1
+ * gives a single run. */
+inline std::vector<uint8_t> periodic(size_t const n, size_t const period, size_t const sigma,
+                                     double const mutation, uint64_t const seed) {
+  if (period == 0) {
+    throw std::invalid_argument("The period must be positive");
+  }
+  std::vector<uint8_t> const base = uniform(period, sigma, seed);
+  std::vector<uint8_t> text(n);
+  for (size_t i = 0; i < n; ++i) {
+    text[i] = base[i % period];
+  }
+  std::mt19937_64 gen(seed + 1);
+  mutate(text, sigma, mutation, gen);
+  return text;
+}
+
+/* n times the character c */
+inline std::vector<uint8_t> run(size_t const n, uint8_t const c) {
+  return std::vector<uint8_t>(n, c);
+}
+
+/* A collection of copies of a random genome over ACGT, like the genomes of
+ * one species: every copy has point mutations with probability mutation
+ * and insertions or deletions of up to 16 characters with probability
+ * mutation / 10 per character. */
+inline std::vector<uint8_t> dna(size_t const n, size_t const copies, double const mutation,
+                                uint64_t const seed) {
+  static constexpr uint8_t kBases[] = {'A', 'C', 'G', 'T'};
+  std::mt19937_64 gen(seed);
+  std::uniform_int_distribution<size_t> base(0, 3);
+  std::uniform_int_distribution<size_t> other_base(1, 3);
+  std::uniform_int_distribution<size_t> indel_length(1, 16);
+  std::bernoulli_distribution insertion(0.5);
+
+  std::vector<uint8_t> genome((n + std::max<size_t>(copies, 1) - 1) / std::max<size_t>(copies, 1));
+  for (auto& c : genome) {
+    c = kBases[base(gen)];
+  }
+
+  std::vector<uint8_t> text;
+  text.reserve(n);
+  while (text.size() < n) {
+    std::vector<uint8_t> copy = genome;
+    for_each_hit(copy.size(), mutation, gen, [&](size_t const i) {
+      copy[i] = kBases[(std::find(kBases, kBases + 4, copy[i]) - kBases + other_base(gen)) % 4];
+    });
+    // Indels in one pass, since inserting into the copy is linear each
+    std::vector<uint8_t> edited;
+    edited.reserve(copy.size());
+    size_t next = 0;
+    for_each_hit(copy.size(), mutation / 10, gen, [&](size_t const i) {
+      if (i < next) {
+        return;
+      }
+      edited.insert(edited.end(), copy.begin() + next, copy.begin() + i);
+      size_t const length = indel_length(gen);
+      if (insertion(gen)) {
+        for (size_t k = 0; k < length; ++k) {
+          edited.push_back(kBases[base(gen)]);
+        }
+        next = i;
+      } else {
+        next = std::min(i + length, copy.size());
+      }
+    });
+    edited.insert(edited.end(), copy.begin() + next, copy.end());
+    copy = std::move(edited);
+    text.insert(text.end(), copy.begin(), copy.begin() + std::min(copy.size(), n - text.size()));
+  }
+  return text;
+}
+
+/* Versions of a document of about doc bytes of English-like words, like
+ * the revisions of a wiki page: each version applies edits random edits
+ * (inserting a sentence, deleting up to 256 characters, or replacing a word)
+ * to the previous one. The versions are concatenated up to length n. */
+inline std::vector<uint8_t> versions(size_t const n, size_t const doc, size_t const edits,
+                                     uint64_t const seed) {
+  if (doc == 0) {
+    throw std::invalid_argument("The document size must be positive");
+  }
+  std::mt19937_64 gen(seed);
+  std::vector<std::string> vocabulary(1024);
+  std::uniform_int_distribution<size_t> word_length(1, 10);
+  std::uniform_int_distribution<int> letter('a', 'z');
+  for (auto& word : vocabulary) {
+    word.resize(word_length(gen));
+    for (auto& c : word) {
+      c = letter(gen);
+    }
+  }
+  // Zipf-like word frequencies, as in natural language
+  std::vector<double> weights(vocabulary.size());
+  for (size_t w = 0; w < weights.size(); ++w) {
+    weights[w] = 1.0 / (w + 1);
+  }
+  std::discrete_distribution<size_t> word(weights.begin(), weights.end());
+  std::uniform_int_distribution<size_t> sentence_length(3, 20);
+  auto sentence = [&]() {
+    std::string result;
+    size_t const length = sentence_length(gen);
+    for (size_t w = 0; w < length; ++w) {
+      result += vocabulary[word(gen)];
+      result += (w + 1 == length) ? ".\n" : " ";
+    }
+    return result;
+  };
+
+  std::vector<uint8_t> document;
+  while (document.size() < doc) {
+    std::string const s = sentence();
+    document.insert(document.end(), s.begin(), s.end());
+  }
+
+  std::uniform_int_distribution<size_t> edit_type(0, 2);
+  std::uniform_int_distribution<size_t> delete_length(1, 256);
+  std::vector<uint8_t> text;
+  text.reserve(n);
+  while (text.size() < n) {
+    text.insert(text.end(), document.begin(),
+                document.begin() + std::min(document.size(), n - text.size()));
+    for (size_t e = 0; e < edits; ++e) {
+      size_t const pos = document.empty()
+          ? 0 : std::uniform_int_distribution<size_t>(0, document.size() - 1)(gen);
+      size_t type = edit_type(gen);
+      if (document.empty() || (type == 1 && document.size() < doc)) {
+        // Keeps the size of the document at about doc bytes.
+        type = 0;
+      }
+      if (type == 0) {
+        std::string const s = sentence();
+        document.insert(document.begin() + pos, s.begin(), s.end());
+      } else if (type == 1) {
+        document.erase(document.begin() + pos,
+                       document.begin() + std::min(pos + delete_length(gen), document.size()));
+      } else {
+        auto const end = std::find(document.begin() + pos, document.end(), ' ');
+        std::string const& w = vocabulary[word(gen)];
+        document.erase(document.begin() + pos, end);
+        document.insert(document.begin() + pos, w.begin(), w.end());
+      }
+    }
+  }
+  return text;
+}
+
+/* The parameters "key=value,..." of a spec. Every parameter must be used. */
+class parameters {
+public:
+  explicit parameters(std::string const& list) {
+    size_t begin = 0;
+    while (begin < list.size()) {
+      size_t end = list.find(',', begin);
+      end = (end == std::string::npos) ? list.size() : end;
+      std::string const item = list.substr(begin, end - begin);
+      size_t const eq = item.find('=');
+      if (eq == std::string::npos) {
+        throw std::invalid_argument("Expected key=value instead of " + item);
+      }
+      values_[item.substr(0, eq)] = item.substr(eq + 1);
+      begin = end + 1;
+    }
+  }
+
+  /* A size with an optional unit, e.g., 64Mi */
+  uint64_t size(std::string const& key, uint64_t const fallback) {
+    std::string const* const value = get(key);
+    uint64_t result = fallback;
+    if (value != nullptr && !tlx::parse_si_iec_units(*value, &result)) {
+      throw std::invalid_argument("Invalid size " + key + "=" + *value);
+    }
+    return result;
+  }
+
+  double real(std::string const& key, double const fallback) {
+    std::string const* const value = get(key);
+    return (value != nullptr) ? std::stod(*value) : fallback;
+  }
+
+  std::string string(std::string const& key, std::string const& fallback) {
+    std::string const* const value = get(key);
+    return (value != nullptr) ? *value : fallback;
+  }
+
+  /* Throws if a parameter was not used. */
+  void check_all_used() const {
+    for (auto const& [key, value] : values_) {
+      if (!used_.contains(key)) {
+        throw std::invalid_argument("Unknown parameter " + key);
+      }
+    }
+  }
+
+private:
+  std::map<std::string, std::string> values_;
+  std::set<std::string> used_;
+
+  std::string const* get(std::string const& key) {
+    auto const it = values_.find(key);
+    if (it == values_.end()) {
+      return nullptr;
+    }
+    used_.insert(key);
+    return &it->second;
+  }
+};
+
+/* Builds the text of a spec "<kind>:<key>=<value>,...". All kinds take the
+ * length n (default 1Mi) and, if they are random, a seed (default 1):
+ *   uniform:sigma=4
+ *   fibonacci
+ *   thue_morse
+ *   periodic:period=1000,sigma=4,mutation=0
+ *   run:char=a
+ *   dna:copies=16,mutation=0.001
+ *   versions:doc=64Ki,edits=8 */
+inline std::vector<uint8_t> generate(std::string const& spec) {
+  size_t const colon = spec.find(':');
+  std::string const kind = spec.substr(0, colon);
+  parameters p((colon == std::string::npos) ? "" : spec.substr(colon + 1));
+  size_t const n = p.size("n", uint64_t{1} << 20);
+
+  std::vector<uint8_t> text;
+  if (kind == "uniform") {
+    text = uniform(n, p.size("sigma", 4), p.size("seed", 1));
+  } else if (kind == "fibonacci") {
+    text = fibonacci(n);
+  } else if (kind == "thue_morse") {
+    text = thue_morse(n);
+  } else if (kind == "periodic") {
+    text = periodic(n, p.size("period", 1000), p.size("sigma", 4), p.real("mutation", 0),
+                    p.size("seed", 1));
+  } else if (kind == "run") {
+    std::string const c = p.string("char", "a");
+    text = run(n, c.empty() ? 'a' : c[0]);
+  } else if (kind == "dna") {
+    text = dna(n, p.size("copies", 16), p.real("mutation", 0.001), p.size("seed", 1));
+  } else if (kind == "versions") {
+    text = versions(n, p.size("doc", uint64_t{1} << 16), p.size("edits", 8), p.size("seed", 1));
+  } else {
+    throw std::invalid_argument("Unknown text generator " + kind);
+  }
+  p.check_all_used();
+  return text;
+}
+}  // namespace textgen
+
+/******************************************************************************/
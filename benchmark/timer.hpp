@@ -10,18 +10,25 @@
 
 #include <chrono>
 
+// Uses the monotonic clock, so that times do not jump with the system time.
 class timer {
 
 public:
-  timer() : begin_(std::chrono::system_clock::now()) { }
+  timer() : begin_(std::chrono::steady_clock::now()) { }
 
   void reset() {
-    begin_ = std::chrono::system_clock::now();
+    begin_ = std::chrono::steady_clock::now();
   }
 
+  // Milliseconds since the construction or the last reset
   size_t get() const {
-    auto const end = std::chrono::system_clock::now();
-    return std::chrono::duration_cast<std::chrono::milliseconds>(end - begin_).count();
+    return get_ns() / 1000000;
+  }
+
+  // Nanoseconds since the construction or the last reset
+  size_t get_ns() const {
+    auto const end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin_).count();
   }
 
   size_t get_and_reset() {
@@ -30,8 +37,14 @@ public:
     return time;
   }
 
+  size_t get_ns_and_reset() {
+    auto const time = get_ns();
+    reset();
+    return time;
+  }
+
 private:
-  std::chrono::system_clock::time_point begin_;
+  std::chrono::steady_clock::time_point begin_;
 }; // class timer
 
 /******************************************************************************/
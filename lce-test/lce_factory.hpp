@@ -0,0 +1,450 @@
+/*******************************************************************************
+ * lce-test/lce_factory.hpp
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "lce_naive.hpp"
+#include "lce_naive_ultra.hpp"
+#include "lce_prezza.hpp"
+#include "lce_prezza_mersenne.hpp"
+#include "lce_semi_synchronizing_sets_par.hpp"
+#include "util/execution.hpp"
+#include "util/lce_interface.hpp"
+#include "util/serialization.hpp"
+#include "util_ssss_par/ssss_par.hpp"
+
+/* Predicted costs of one LCE data structure. The names are the ones of the
+ * -a option of bench_time (e.g. s512, s512_hier). */
+struct lce_candidate {
+  std::string name;
+  bool prefer_long = false;
+  double construction_ms = 0;
+  size_t memory_bytes = 0;      // Size of the data structure without the text
+  size_t construction_peak = 0; // Peak memory during construction without the text
+  double query_ns = 0;          // Expected time of one query
+  double total_ms = 0;          // Construction and all expected queries
+  bool fits = true;             // Is construction_peak within the budget?
+
+  friend std::ostream& operator<<(std::ostream& os, lce_candidate const& c) {
+    return os << "name=" << c.name << (c.prefer_long ? "pl" : "") << " "
+              << "predicted_construction_time=" << c.construction_ms << " "
+              << "predicted_mem=" << c.memory_bytes << " "
+              << "predicted_mem_peak=" << c.construction_peak << " "
+              << "predicted_query_time=" << c.query_ns << " "
+              << "predicted_total_time=" << c.total_ms << " "
+              << "fits=" << std::boolalpha << c.fits;
+  }
+};
+
+/* Options of LceFactory */
+struct lce_factory_options {
+  size_t memory_budget = std::numeric_limits<size_t>::max();
+  uint64_t expected_queries = 1'000'000;
+  size_t num_samples = 16;
+  size_t sample_length = size_t{1} << 16;
+  // LCEs of sampled queries are computed naively up to this length. Longer
+  // LCEs count as max_scan.
+  size_t max_scan = size_t{1} << 20;
+};
+
+/* Costs in nanoseconds, construction costs are per thread. */
+struct lce_cost_model {
+  double miss_ns = 80;             // Random access to a large array
+  double byte_scan_ns = 0.4;       // Compare one character
+  double block_scan_ns = 0.6;      // Compare 16 characters at once
+  double prezza_build_ns = 4;      // Per character
+  double mersenne_build_ns = 12;   // Per character
+  double sync_set_build_ns = 8;    // Per character
+  double string_sort_ns = 25;      // Per sync position and log2 of the set size
+  double suffix_array_ns = 120;    // Per sync position
+  double lcp_ns = 250;             // Per sync position
+  double hierarchy_build_ns = 60;  // Per sync position
+};
+
+/* Chooses and builds the LCE data structure that is expected to be the
+ * fastest for a text. The text is analyzed with a few samples: the density of
+ * the string synchronizing sets for every tau, whether the run detection
+ * triggers and the alphabet size. Queries are described by a sample of query
+ * pairs (or random pairs, if none are given) whose LCEs are put into a
+ * histogram with logarithmic buckets. A simple cost model then predicts
+ * construction time, memory and query time of every candidate. The constants
+ * of the model are rough defaults and can be adjusted with bench_time. */
+class LceFactory {
+ public:
+  static constexpr std::array<uint64_t, 4> kTaus = {256, 512, 1024, 2048};
+  static constexpr size_t kNumBuckets = 65;
+
+  using options = lce_factory_options;
+  using cost_model = lce_cost_model;
+
+  /* Analyzes the text. The text has to outlive the factory. */
+  LceFactory(std::span<uint8_t const> const text, options const& opt = options())
+      : text_(text), opt_(opt) {
+    sample_text();
+  }
+
+  /* Adds query pairs (lce_indices[2k], lce_indices[2k + 1]) to the sample. */
+  void add_query_sample(std::vector<uint64_t> const& lce_indices) {
+    for (size_t k = 0; k + 1 < lce_indices.size(); k += 2) {
+      add_query(lce_indices[k], lce_indices[k + 1]);
+    }
+  }
+
+  /* Adds random query pairs to the sample. */
+  void add_random_queries(size_t const num_queries, uint64_t const seed = 1) {
+    if (text_.empty()) {
+      return;
+    }
+    std::mt19937_64 gen(seed);
+    std::uniform_int_distribution<uint64_t> pos(0, text_.size() - 1);
+    for (size_t k = 0; k < num_queries; ++k) {
+      add_query(pos(gen), pos(gen));
+    }
+  }
+
+  cost_model& costs() {
+    return costs_;
+  }
+
+  size_t alphabet_size() const {
+    return alphabet_size_;
+  }
+
+  /* Expected number of sync positions per character for kTaus[t] */
+  double sync_set_density(size_t const t) const {
+    return density_[t];
+  }
+
+  bool has_runs(size_t const t) const {
+    return runs_[t];
+  }
+
+  /* Number of sampled queries with an LCE in [2^(b-1), 2^b) (bucket 0 holds
+     the LCEs of length 0) */
+  std::array<uint64_t, kNumBuckets> const& lce_histogram() const {
+    return histogram_;
+  }
+
+  /* Predicts the costs of all candidates, the cheapest first. */
+  std::vector<lce_candidate> candidates() {
+    if (num_queries_ == 0) {
+      add_random_queries(1'000);
+    }
+    std::vector<lce_candidate> result;
+    result.push_back(predict_naive("u", costs_.byte_scan_ns));
+    result.push_back(predict_naive("n", costs_.block_scan_ns / 16));
+    result.push_back(predict_prezza("p", 128, costs_.prezza_build_ns, 0));
+    size_t const bits = std::max<size_t>(1, std::ceil(std::log2(std::max<size_t>(alphabet_size_, 2))));
+    result.push_back(predict_prezza("m", 127, costs_.mersenne_build_ns, 2 * bits * text_.size() / 8));
+    for (size_t t = 0; t < kTaus.size(); ++t) {
+      if (!sampled_[t]) {
+        continue;
+      }
+      result.push_back(predict_sss(t, false, false));
+      result.push_back(predict_sss(t, true, false));
+      result.push_back(predict_sss(t, false, true));
+    }
+
+    for (auto& c : result) {
+      c.total_ms = c.construction_ms + opt_.expected_queries * c.query_ns / 1e6;
+      c.fits = c.construction_peak <= opt_.memory_budget;
+    }
+    std::stable_sort(result.begin(), result.end(), [](lce_candidate const& lhs, lce_candidate const& rhs) {
+      if (lhs.fits != rhs.fits) {
+        return lhs.fits;
+      }
+      return lhs.fits ? lhs.total_ms < rhs.total_ms : lhs.construction_peak < rhs.construction_peak;
+    });
+    return result;
+  }
+
+  /* The cheapest candidate within the memory budget (or the one with the
+     smallest peak, if none fits). */
+  lce_candidate best() {
+    return candidates().front();
+  }
+
+  /* Builds the candidate. Prezza's data structure works in-place, i.e., it
+     changes the text. All others keep a reference to the text. */
+  static std::unique_ptr<LceDataStructure> build(lce_candidate const& c, std::vector<uint8_t>& text) {
+    if (c.name == "p") {
+      // Make sure the text can be divided into 64 bit blocks
+      text.resize(text.size() + (8 - (text.size() % 8)));
+      return std::make_unique<LcePrezza<128>>(reinterpret_cast<uint64_t*>(text.data()), text.size());
+    }
+    return build(c, std::span<uint8_t const>(text));
+  }
+
+  /* Builds the candidate on a read-only text, e.g., a memory mapped one. */
+  static std::unique_ptr<LceDataStructure> build(lce_candidate const& c, std::span<uint8_t const> const text) {
+    if (c.name == "u") {
+      return std::make_unique<LceUltraNaive>(text);
+    } else if (c.name == "n") {
+      return std::make_unique<LceNaive>(text);
+    } else if (c.name == "p") {
+      throw std::invalid_argument("Prezza's LCE data structure needs a mutable text");
+    } else if (c.name == "m") {
+      return std::make_unique<rklce::LcePrezzaMersenne>(text);
+    }
+    bool const hierarchical = c.name.size() > 5 && c.name.substr(c.name.size() - 5) == "_hier";
+    switch (sss_tau(c.name)) {
+      case 256: return build_sss<256>(text, c.prefer_long, hierarchical);
+      case 512: return build_sss<512>(text, c.prefer_long, hierarchical);
+      case 1024: return build_sss<1024>(text, c.prefer_long, hierarchical);
+      case 2048: return build_sss<2048>(text, c.prefer_long, hierarchical);
+      default: throw std::invalid_argument("Unknown LCE data structure " + c.name);
+    }
+  }
+
+  /* The tau of a string synchronizing set name like "s512" or "s512_hier",
+     or 0 if the name is not one. */
+  static uint64_t sss_tau(std::string const& name) {
+    size_t const digits_end = std::min(name.find('_'), name.size());
+    std::string const digits = name.substr(std::min<size_t>(1, name.size()), digits_end - 1);
+    bool const valid = name.starts_with('s') && !digits.empty() && digits.size() < 10 &&
+                       digits.find_first_not_of("0123456789") == std::string::npos &&
+                       (digits_end == name.size() || name.substr(digits_end) == "_hier");
+    return valid ? std::stoull(digits) : 0;
+  }
+
+  /* Maps the candidate from a file that was written by its save(). */
+  static std::unique_ptr<LceDataStructure> open(lce_candidate const& c, std::string const& path,
+                                                lce_test::serialization::map_options const& opt =
+                                                    lce_test::serialization::map_options()) {
+    if (c.name == "u") {
+      return LceUltraNaive::open_mmap(path, opt);
+    } else if (c.name == "n") {
+      return LceNaive::open_mmap(path, opt);
+    } else if (c.name == "p") {
+      return LcePrezza<128>::open_mmap(path, opt);
+    } else if (c.name == "m") {
+      throw std::invalid_argument("Prezza's Mersenne LCE data structure cannot be mapped");
+    }
+    bool const hierarchical = c.name.size() > 5 && c.name.substr(c.name.size() - 5) == "_hier";
+    switch (sss_tau(c.name)) {
+      case 256: return open_sss<256>(path, opt, c.prefer_long, hierarchical);
+      case 512: return open_sss<512>(path, opt, c.prefer_long, hierarchical);
+      case 1024: return open_sss<1024>(path, opt, c.prefer_long, hierarchical);
+      case 2048: return open_sss<2048>(path, opt, c.prefer_long, hierarchical);
+      default: throw std::invalid_argument("Unknown LCE data structure " + c.name);
+    }
+  }
+
+ private:
+  std::span<uint8_t const> const text_;
+  options opt_;
+  cost_model costs_;
+  int const threads_ = lce_test::execution::default_policy().num_threads();
+
+  size_t alphabet_size_ = 0;
+  std::array<double, kTaus.size()> density_ = {};
+  std::array<bool, kTaus.size()> runs_ = {};
+  std::array<bool, kTaus.size()> sampled_ = {};
+
+  std::array<uint64_t, kNumBuckets> histogram_ = {};
+  std::array<double, kNumBuckets> histogram_sum_ = {};
+  uint64_t num_queries_ = 0;
+
+  template <uint64_t kTau>
+  static std::unique_ptr<LceDataStructure> build_sss(std::span<uint8_t const> const text, bool const prefer_long,
+                                                     bool const hierarchical) {
+    using lce_test::execution::default_policy;
+    using lce_test::par::LceSemiSyncSetsPar;
+    using lce_test::par::query_mode;
+    constexpr query_mode kLong = query_mode::successor_first;
+    constexpr query_mode kShort = query_mode::scan_first;
+    if (hierarchical) {
+      if (prefer_long) {
+        return std::make_unique<LceSemiSyncSetsPar<kTau, kLong, default_policy, true>>(text, false);
+      }
+      return std::make_unique<LceSemiSyncSetsPar<kTau, kShort, default_policy, true>>(text, false);
+    }
+    if (prefer_long) {
+      return std::make_unique<LceSemiSyncSetsPar<kTau, kLong>>(text, false);
+    }
+    return std::make_unique<LceSemiSyncSetsPar<kTau, kShort>>(text, false);
+  }
+
+  template <uint64_t kTau>
+  static std::unique_ptr<LceDataStructure> open_sss(std::string const& path,
+                                                    lce_test::serialization::map_options const& opt,
+                                                    bool const prefer_long, bool const hierarchical) {
+    using lce_test::execution::default_policy;
+    using lce_test::par::LceSemiSyncSetsPar;
+    using lce_test::par::query_mode;
+    constexpr query_mode kLong = query_mode::successor_first;
+    constexpr query_mode kShort = query_mode::scan_first;
+    if (hierarchical) {
+      if (prefer_long) {
+        return LceSemiSyncSetsPar<kTau, kLong, default_policy, true>::open_mmap(path, opt);
+      }
+      return LceSemiSyncSetsPar<kTau, kShort, default_policy, true>::open_mmap(path, opt);
+    }
+    if (prefer_long) {
+      return LceSemiSyncSetsPar<kTau, kLong>::open_mmap(path, opt);
+    }
+    return LceSemiSyncSetsPar<kTau, kShort>::open_mmap(path, opt);
+  }
+
+  /* Computes the sync sets of evenly spaced windows of the text. */
+  void sample_text() {
+    size_t const n = text_.size();
+    size_t const num_samples = std::max<size_t>(opt_.num_samples, 1);
+    size_t const window = std::min(n, opt_.sample_length);
+    size_t const step = (n <= num_samples * window) ? window : n / num_samples;
+
+    std::array<bool, 256> seen = {};
+    std::array<size_t, kTaus.size()> sync_positions = {};
+    std::array<size_t, kTaus.size()> sampled_length = {};
+    for (size_t begin = 0; window > 0 && begin + window <= n; begin += step) {
+      std::span<uint8_t const> const sample = text_.subspan(begin, window);
+      for (uint8_t const c : sample) {
+        seen[c] = true;
+      }
+      sample_sync_set<0>(sample, sync_positions, sampled_length);
+    }
+    alphabet_size_ = std::count(seen.begin(), seen.end(), true);
+    for (size_t t = 0; t < kTaus.size(); ++t) {
+      sampled_[t] = sampled_length[t] > 0;
+      density_[t] = sampled_[t] ? double(sync_positions[t]) / sampled_length[t] : 0;
+    }
+  }
+
+  template <size_t t>
+  void sample_sync_set(std::span<uint8_t const> const sample, std::array<size_t, kTaus.size()>& sync_positions,
+                       std::array<size_t, kTaus.size()>& sampled_length) {
+    if constexpr (t < kTaus.size()) {
+      if (sample.size() >= 3 * kTaus[t]) {
+        string_synchronizing_set_par<kTaus[t], uint64_t> const sync_set(sample, lce_test::execution::sequential());
+        sync_positions[t] += sync_set.size();
+        sampled_length[t] += sample.size();
+        runs_[t] = runs_[t] || sync_set.has_runs();
+      }
+      sample_sync_set<t + 1>(sample, sync_positions, sampled_length);
+    }
+  }
+
+  void add_query(uint64_t i, uint64_t j) {
+    if (i >= text_.size() || j >= text_.size()) {
+      return;
+    }
+    uint64_t lce = text_.size() - std::max(i, j);
+    if (i != j) {
+      uint64_t const max_length = std::min<uint64_t>(lce, opt_.max_scan);
+      lce = 0;
+      while (lce < max_length && text_[i + lce] == text_[j + lce]) {
+        ++lce;
+      }
+    }
+    size_t const bucket = (lce == 0) ? 0 : 64 - __builtin_clzll(lce);
+    ++histogram_[bucket];
+    histogram_sum_[bucket] += lce;
+    ++num_queries_;
+  }
+
+  /* Averages query_cost(lce) over the histogram. */
+  template <typename F>
+  double expected_query_ns(F const& query_cost) const {
+    double sum = 0;
+    for (size_t b = 0; b < kNumBuckets; ++b) {
+      if (histogram_[b] > 0) {
+        sum += histogram_[b] * query_cost(histogram_sum_[b] / histogram_[b]);
+      }
+    }
+    return sum / std::max<uint64_t>(num_queries_, 1);
+  }
+
+  lce_candidate predict_naive(std::string const& name, double const scan_ns) const {
+    lce_candidate c;
+    c.name = name;
+    c.query_ns = expected_query_ns([&](double const lce) {
+      return 2 * costs_.miss_ns + lce * scan_ns;
+    });
+    return c;
+  }
+
+  lce_candidate predict_prezza(std::string const& name, double const naive_scan, double const build_ns,
+                               size_t const memory) const {
+    lce_candidate c;
+    c.name = name;
+    c.construction_ms = text_.size() * build_ns / 1e6;
+    c.memory_bytes = memory;
+    c.construction_peak = memory;
+    c.query_ns = expected_query_ns([&](double const lce) {
+      double cost = 2 * costs_.miss_ns + std::min(lce, naive_scan) * costs_.block_scan_ns / 8;
+      if (lce >= naive_scan) {
+        // Exponential and binary search with two fingerprints per step
+        cost += 4 * std::log2(lce + 1) * costs_.miss_ns;
+      }
+      return cost;
+    });
+    return c;
+  }
+
+  lce_candidate predict_sss(size_t const t, bool const prefer_long, bool const hierarchical) const {
+    double const tau = kTaus[t];
+    double const n = text_.size();
+    double const s = std::max(1.0, density_[t] * n);
+    double const threads = threads_;
+
+    lce_candidate c;
+    c.name = "s" + std::to_string(kTaus[t]) + (hierarchical ? "_hier" : "");
+    c.prefer_long = prefer_long;
+
+    double build_ns = n * costs_.sync_set_build_ns + s * std::log2(s) * costs_.string_sort_ns;
+    // Sync set and successor index. Then ISA, LCP and RMQ or the hierarchy.
+    c.memory_bytes = 8 * s + s / 8;
+    if (hierarchical) {
+      build_ns += s * costs_.hierarchy_build_ns;
+      c.memory_bytes += 6 * s;
+      c.construction_peak = c.memory_bytes + 16 * s;
+    } else {
+      build_ns += s * (costs_.suffix_array_ns + costs_.lcp_ns);
+      c.memory_bytes += 13 * s;
+      c.construction_peak = c.memory_bytes + 24 * s;
+    }
+    c.construction_ms = build_ns / threads / 1e6;
+
+    double const successor_ns = 2 * 2 * costs_.miss_ns;
+    double const levels = hierarchical ? std::max(1.0, std::ceil(std::log2(s / 65536.0) / 3)) : 0;
+    // Long LCEs: rmq on the reduced LCP array or one step per level, then the mismatch
+    double const long_ns = (hierarchical ? levels * (successor_ns + 64 * costs_.byte_scan_ns) + 4 * costs_.miss_ns
+                                         : 4 * costs_.miss_ns) +
+                           2 * costs_.miss_ns + 3 * tau * costs_.block_scan_ns / 16;
+    double const distance = 1 / std::max(density_[t], 1 / n);
+    c.query_ns = expected_query_ns([&](double const lce) {
+      double cost = 2 * costs_.miss_ns;
+      if (prefer_long) {
+        cost += successor_ns + std::min(lce, distance) * costs_.block_scan_ns / 16;
+        if (lce >= distance) {
+          cost += long_ns;
+        }
+      } else {
+        cost += std::min(lce, 3 * tau) * costs_.block_scan_ns / 16;
+        if (lce >= 3 * tau) {
+          cost += successor_ns + long_ns;
+        }
+      }
+      return cost;
+    });
+    return c;
+  }
+};
+
+/******************************************************************************/
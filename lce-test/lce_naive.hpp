@@ -9,11 +9,15 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
 #include <vector>
 
 #include <tlx/define/likely.hpp>
 
 #include "util/lce_interface.hpp"
+#include "util/serialization.hpp"
 
 /* This class stores a text as an array of characters and 
  * answers LCE-queries with the naive method. */
@@ -22,8 +26,21 @@ class LceNaive : public LceDataStructure {
 public:
   __extension__ typedef unsigned __int128 uint128_t;
 
-  LceNaive(std::vector<uint8_t> const& text)
-    : text_(text), text_length_in_bytes_(text.size()) { }
+  LceNaive(std::span<uint8_t const> const text)
+    : text_(text.data()), text_length_in_bytes_(text.size()) { }
+
+  /* Stores the text in a file. */
+  void save(std::string const& path) const override {
+    lce_test::serialization::writer out(path, "text");
+    out.write_array(text_, text_length_in_bytes_);
+  }
+
+  /* Maps a text that was stored with save(). */
+  static std::unique_ptr<LceNaive> open_mmap(std::string const& path,
+      lce_test::serialization::map_options const& opt = lce_test::serialization::map_options()) {
+    lce_test::serialization::reader in(path, "text", opt);
+    return std::unique_ptr<LceNaive>(new LceNaive(in));
+  }
 
   /* Naive LCE-query */
   uint64_t lce(const uint64_t i, const uint64_t j) {
@@ -32,7 +49,41 @@ public:
       return text_length_in_bytes_ - i;
     }
 
-    const uint64_t max_length = text_length_in_bytes_ - ((i < j) ? j : i);
+    return scan(i, j, text_length_in_bytes_ - ((i < j) ? j : i));
+  }
+
+  /* Scans at most bound characters */
+  uint64_t lce_bounded(const uint64_t i, const uint64_t j, const uint64_t bound) {
+    if (TLX_UNLIKELY(i == j)) {
+      return std::min(text_length_in_bytes_ - i, bound);
+    }
+    return scan(i, j, std::min(text_length_in_bytes_ - ((i < j) ? j : i), bound));
+  }
+
+  inline char operator[](const uint64_t i) {
+    return text_[i];
+  }
+
+  int isSmallerSuffix(const uint64_t i, const uint64_t j) {
+    uint64_t lce_s = lce(i, j);
+    if(TLX_UNLIKELY((i + lce_s + 1 == text_length_in_bytes_) ||
+                (j + lce_s + 1 == text_length_in_bytes_))) {
+      return true;
+    }
+    return (text_[i + lce_s] < text_[j + lce_s]);
+  }
+
+  uint64_t getSizeInBytes() {
+    return text_length_in_bytes_;
+  }
+
+  std::vector<space_component> space_breakdown() const {
+    return {{"text", text_length_in_bytes_}};
+  }
+
+private: 
+  /* The LCE of i != j, but at most max_length */
+  uint64_t scan(const uint64_t i, const uint64_t j, const uint64_t max_length) {
     uint64_t lce = 0;
     // First we compare the first few characters. We do this, because in the
     // usual case the lce is low.
@@ -48,9 +99,9 @@ public:
     // Accelerate search by comparing 16-byte blocks
     lce = 0;
     uint128_t const* const text_blocks_i =
-      reinterpret_cast<uint128_t const*>(text_.data() + i);
+      reinterpret_cast<uint128_t const*>(text_ + i);
     uint128_t const * const text_blocks_j =
-      reinterpret_cast<uint128_t const *>(text_.data() + j);
+      reinterpret_cast<uint128_t const *>(text_ + j);
     for(; lce < max_length/16; ++lce) {
       if(text_blocks_i[lce] != text_blocks_j[lce]) {
         break;
@@ -67,26 +118,16 @@ public:
     return lce;
   }
 
-  inline char operator[](const uint64_t i) {
-    return text_[i];
+  LceNaive(lce_test::serialization::reader& in)
+    : file_(in.file()), text_(nullptr), text_length_in_bytes_(0) {
+    lce_test::serialization::array<uint8_t> const text = in.read_array<uint8_t>();
+    text_ = text.data();
+    text_length_in_bytes_ = text.size();
   }
 
-  int isSmallerSuffix(const uint64_t i, const uint64_t j) {
-    uint64_t lce_s = lce(i, j);
-    if(TLX_UNLIKELY((i + lce_s + 1 == text_length_in_bytes_) ||
-                (j + lce_s + 1 == text_length_in_bytes_))) {
-      return true;
-    }
-    return (text_[i + lce_s] < text_[j + lce_s]);
-  }
-
-  uint64_t getSizeInBytes() {
-    return text_length_in_bytes_;
-  }
-
-private: 
-  std::vector<uint8_t> const& text_;
-  const uint64_t text_length_in_bytes_;
+  std::shared_ptr<lce_test::serialization::mapped_file> file_;
+  uint8_t const* text_;
+  uint64_t text_length_in_bytes_;
 };
 
 /******************************************************************************/
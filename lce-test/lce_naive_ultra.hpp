@@ -10,11 +10,15 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
 #include <vector>
 
 #include <tlx/define/likely.hpp>
 
 #include "util/lce_interface.hpp"
+#include "util/serialization.hpp"
 
 
 /* This class stores a text as an array of characters and 
@@ -22,8 +26,21 @@
 
 class LceUltraNaive : public LceDataStructure {
 public:
-  LceUltraNaive(std::vector<uint8_t> const& text)
-    : text_(text), text_length_in_bytes_(text.size()) { }
+  LceUltraNaive(std::span<uint8_t const> const text)
+    : text_(text.data()), text_length_in_bytes_(text.size()) { }
+
+  /* Stores the text in a file. */
+  void save(std::string const& path) const override {
+    lce_test::serialization::writer out(path, "text");
+    out.write_array(text_, text_length_in_bytes_);
+  }
+
+  /* Maps a text that was stored with save(). */
+  static std::unique_ptr<LceUltraNaive> open_mmap(std::string const& path,
+      lce_test::serialization::map_options const& opt = lce_test::serialization::map_options()) {
+    lce_test::serialization::reader in(path, "text", opt);
+    return std::unique_ptr<LceUltraNaive>(new LceUltraNaive(in));
+  }
 
   /* Naive LCE-query */
   uint64_t lce(const uint64_t i, const uint64_t j) {
@@ -38,6 +55,16 @@ public:
     }
     return lce;
   }
+
+  /* Scans at most bound characters */
+  uint64_t lce_bounded(const uint64_t i, const uint64_t j, const uint64_t bound) {
+    const uint64_t max_length = std::min(text_length_in_bytes_ - ((i < j) ? j : i), bound);
+    uint64_t lce = 0;
+    while(lce < max_length && text_[i + lce] == text_[j + lce]) {
+      lce++;
+    }
+    return lce;
+  }
 		
   inline char operator[](const uint64_t i) {
     return text_[i];
@@ -55,10 +82,22 @@ public:
   uint64_t getSizeInBytes() {
     return text_length_in_bytes_;
   }
+
+  std::vector<space_component> space_breakdown() const {
+    return {{"text", text_length_in_bytes_}};
+  }
 		
 private:
-  std::vector<uint8_t> const& text_;
-  const uint64_t text_length_in_bytes_;
+  LceUltraNaive(lce_test::serialization::reader& in)
+    : file_(in.file()), text_(nullptr), text_length_in_bytes_(0) {
+    lce_test::serialization::array<uint8_t> const text = in.read_array<uint8_t>();
+    text_ = text.data();
+    text_length_in_bytes_ = text.size();
+  }
+
+  std::shared_ptr<lce_test::serialization::mapped_file> file_;
+  uint8_t const* text_;
+  uint64_t text_length_in_bytes_;
 };
 
 /******************************************************************************/
@@ -9,8 +9,12 @@
 #pragma once
 
 #include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "util/lce_interface.hpp"
+#include "util/serialization.hpp"
 #include "util/util.hpp"
 #include <cmath>
 #include <bit>
@@ -45,6 +49,24 @@ public:
       calculateFingerprints();
   }
 
+  /* Stores the fingerprints in a file. */
+  void save(std::string const& path) const override {
+    lce_test::serialization::writer out(path, type_name());
+    out.write(text_length_in_bytes_);
+    // Queries may read the block after the last one.
+    std::vector<uint64_t> blocks(fingerprints_, fingerprints_ + text_length_in_blocks_);
+    blocks.push_back(0);
+    out.write_array(blocks);
+  }
+
+  /* Maps fingerprints that were stored with save(). The mapping is read-only,
+     so retransform_text() must not be called. */
+  static std::unique_ptr<LcePrezza> open_mmap(std::string const& path,
+      lce_test::serialization::map_options const& opt = lce_test::serialization::map_options()) {
+    lce_test::serialization::reader in(path, type_name(), opt);
+    return std::unique_ptr<LcePrezza>(new LcePrezza(in));
+  }
+
 
   uint64_t lce_scan(const uint64_t i, const uint64_t j, uint64_t max_lce) {
     uint64_t lce = 0;
@@ -151,6 +173,11 @@ public:
     return text_length_in_bytes_;
   }
 
+  // The fingerprints replace the text.
+  std::vector<space_component> space_breakdown() const {
+    return {{"fingerprints", text_length_in_blocks_ * sizeof(uint64_t)}};
+  }
+
   void retransform_text() {
     for(size_t i{text_length_in_blocks_}; i > 0; --i) {
       fingerprints_[i] = getBlockGuaranteeIgeqOne(i);
@@ -160,6 +187,7 @@ public:
   }
 
 private:
+  std::shared_ptr<lce_test::serialization::mapped_file> file_;
   uint64_t text_length_in_bytes_;
   uint64_t text_length_in_blocks_;
   static constexpr uint128_t prime_{0x800000000000001d};
@@ -168,6 +196,16 @@ private:
   uint64_t * fingerprints_; //We overwrite the text and store the pointer here;
   static constexpr std::array<uint64_t, 70> power_table_ = calculatePowers();
 
+  LcePrezza(lce_test::serialization::reader& in)
+  : file_(in.file()),
+    text_length_in_bytes_(in.read<uint64_t>()),
+    text_length_in_blocks_(text_length_in_bytes_ / 8 + (text_length_in_bytes_ % 8 == 0 ? 0 : 1)),
+    fingerprints_(const_cast<uint64_t*>(in.read_array<uint64_t>().data())) { }
+
+  static std::string type_name() {
+    return "LcePrezza<" + std::to_string(t_naive_scan) + ">";
+  }
+
   uint64_t lce_scan_to_end(const uint64_t i, const uint64_t j, uint64_t max_lce) {
     uint64_t lce = 0;
     /* naive part of lce query */
@@ -206,6 +244,10 @@ private:
   }
 
 
+public:
+  /* The accessors of blocks and fingerprints are public, so that
+     bench_kernels can measure them in isolation. */
+
   /* Returns the i'th block. A block contains 8 character. */
   uint64_t getBlock(const uint64_t i) const {
     uint128_t x = (i != 0) ? fingerprints_[i - 1] & 0x7FFFFFFFFFFFFFFFULL : 0;
@@ -295,6 +337,7 @@ private:
     return static_cast<uint64_t>(fingerprint);
   }
 
+private:
   /* Overwrites the n'th block with the fingerprint of the first n blocks.
      Because the Rabin-Karp fingerprint uses a rolling hash function,
      this is done in O(n) time. */
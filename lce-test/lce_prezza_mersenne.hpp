@@ -47,6 +47,8 @@
 #ifndef INTERNAL_RK_LCE_HPP_
 #define INTERNAL_RK_LCE_HPP_
 
+#include <span>
+
 #include "util/prezza_mersenne/rk_lce_bin.hpp"
 #include "util/prezza_mersenne/includes.hpp"
 #include "util/lce_interface.hpp"
@@ -62,7 +64,7 @@ namespace rklce {
     /*
      * Build RK-LCP structure over the text stored at this path
      */
-    LcePrezzaMersenne(std::vector<uint8_t>& text) : 
+    LcePrezzaMersenne(std::span<uint8_t const> const text) : 
       n_{text.size()}, text_{text.data()} {
         char_to_uint = vector<uint8_t>(256);
         uint_to_char = vector<char>(256);
@@ -239,6 +241,12 @@ namespace rklce {
       return n_;
     }
 
+    std::vector<space_component> space_breakdown() const {
+      return {{"text", n_},
+              {"fingerprints", bin_lce.bit_size() / 8},
+              {"alphabet", char_to_uint.size() + uint_to_char.size()}};
+    }
+
     inline uint16_t alphabet_size() {
       return sigma;
     }
@@ -250,7 +258,7 @@ namespace rklce {
   
     // text length
     const uint64_t n_;
-    uint8_t * const text_;
+    uint8_t const* const text_;
   
 
     // padding at the left of the text to reach a size multiple of B
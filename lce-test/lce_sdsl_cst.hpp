@@ -56,6 +56,10 @@ public:
     return size_;
   }
 
+  std::vector<space_component> space_breakdown() const {
+    return {{"cst", sdsl::size_in_bytes(cst_)}};
+  }
+
 }; // class LceSDSL
 
 using LceSDSLsada = LceSDSL<sdsl::cst_sada<>>;
@@ -0,0 +1,353 @@
+/*******************************************************************************
+ * lce_semi_synchronizing_sets_external.hpp
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <queue>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <ips4o.hpp>
+
+#include "lce_semi_synchronizing_sets_par.hpp"
+#include "util/execution.hpp"
+#include "util/phase_profiler.hpp"
+#include "util/pread_file.hpp"
+#include "util/serialization.hpp"
+#include "util_ssss_par/ssss_par.hpp"
+
+namespace lce_test::par {
+
+/* ram_budget limits the memory for the parts of the construction that
+ * depend on the length of the text. Temporary files go to tmp_dir. */
+struct external_options {
+  uint64_t ram_budget = uint64_t{1} << 30;
+  std::string tmp_dir = "/tmp";
+  uint64_t prefix_size = 0;
+};
+
+/* Builds the string synchronizing set LCE data structure for a text that
+ * does not fit into memory and writes it to index_path in the format of
+ * LceSemiSyncSetsPar::save(). Open it with open_mmap() or
+ * open_semi_external().
+ *
+ * 1. The text is streamed in chunks that overlap by 2 * kTau - 1
+ *    characters to compute the string synchronizing set.
+ * 2. Consecutive positions whose strings fit into a quarter of the budget
+ *    are sorted by their 3 * kTau long strings and written to run files,
+ *    which are merged with a multiway merge to name the strings.
+ * 3. The suffix array, LCP array and RMQ (or the hierarchy) of the reduced
+ *    text are built in memory. They, the string synchronizing set and its
+ *    predecessor index have about n / kTau entries and must fit into the
+ *    budget. The LCEs of the text for the LCP array are read with pread in
+ *    blocks of 3 * kTau characters per thread.
+ * 4. The text is copied to the index in chunks of a quarter of the budget.
+ *
+ * Texts with long runs, for which the string synchronizing set needs run
+ * information, are not supported. */
+template <uint64_t kTau, bool hierarchical = false,
+          typename Exec = execution::default_policy>
+class LceSemiSyncSetsExternal {
+  using lce_type = LceSemiSyncSetsPar<kTau, query_mode::scan_first, Exec, hierarchical>;
+  using sss_type = typename lce_type::sss_type;
+
+  static constexpr size_t kStringLength = 3 * kTau;
+
+  /* A string of a run file. */
+  struct record {
+    uint64_t index;
+    uint64_t length;
+    std::array<uint8_t, kStringLength> chars;
+  };
+
+ public:
+  static void build(std::string const& text_path, std::string const& index_path,
+                    external_options const& opt = external_options(),
+                    Exec const& exec = Exec()) {
+    LceSemiSyncSetsExternal builder(text_path, opt, exec);
+    builder.write_index(index_path);
+  }
+
+ private:
+  external_options const opt_;
+  Exec const& exec_;
+  pread_file const file_;
+  size_t const n_;
+  std::vector<sss_type> sss_;
+  std::vector<std::string> run_files_;
+
+  LceSemiSyncSetsExternal(std::string const& text_path, external_options const& opt,
+                          Exec const& exec)
+      : opt_(opt), exec_(exec), file_(text_path, opt.prefix_size), n_(file_.size()) {
+    if (n_ < 3 * kTau) {
+      throw std::runtime_error("The text is too short for the external memory construction");
+    }
+  }
+
+  ~LceSemiSyncSetsExternal() {
+    for (auto const& path : run_files_) {
+      std::remove(path.c_str());
+    }
+  }
+
+  /* Two strings are equal, if the shorter one is a prefix of the longer one
+     (see Lce_rmq_par::eq_three_tau). */
+  static int compare(record const& a, record const& b) {
+    return std::memcmp(a.chars.data(), b.chars.data(), std::min(a.length, b.length));
+  }
+
+  static bool less(record const& a, record const& b) {
+    int const cmp = compare(a, b);
+    return (cmp != 0) ? (cmp < 0) : (a.length < b.length);
+  }
+
+  /* Strings that are cut off by the end of the text and the last string
+     get names of their own in the hierarchical mode. */
+  bool has_unique_name(size_t const k) const {
+    return hierarchical && (sss_[k] + kStringLength > n_ || k + 1 == sss_.size());
+  }
+
+  void compute_sync_set() {
+    string_synchronizing_set_par<kTau, sss_type> const sync_set{};
+    size_t const sss_end = n_ - 2 * kTau + 1;
+    size_t const chunk = std::max<size_t>(opt_.ram_budget / 4, 16 * kTau);
+    std::vector<uint8_t> buffer;
+    std::vector<std::vector<sss_type>> sss_part(exec_.num_threads());
+    for (size_t from = 0; from < sss_end; from += chunk) {
+      size_t const to = std::min(from + chunk, sss_end);
+      // Position i depends on text[i, i + 2 * kTau - 1).
+      size_t const text_end = to + 2 * kTau - 1;
+      buffer.resize(text_end - from);
+      file_.read(buffer.data(), from, text_end);
+      std::span<uint8_t const> const text(buffer);
+      exec_.for_each_block([&](int const t, int const nt) {
+        auto const [start, end] = execution::block_range(to - from, t, nt);
+        sss_part[t].clear();
+        if (start < end) {
+          sss_part[t] = sync_set.fill_synchronizing_set(text, start, end);
+        }
+      });
+      for (auto const& part : sss_part) {
+        for (sss_type const pos : part) {
+          sss_.push_back(from + pos);
+        }
+      }
+    }
+    if (sss_.size() > n_ * 6 / kTau) {
+      throw std::runtime_error("The text has long runs, which the external memory construction does not support");
+    }
+  }
+
+  /* The LCE of the text positions i and j. Both are read in blocks of
+     kStringLength characters, so that the text never has to be in memory.
+     A failed read throws, which the parallel LCP computation of Lce_rmq_par
+     passes on after all of its blocks are done. */
+  uint64_t lce_in_file(uint64_t const i, uint64_t const j) const {
+    std::array<uint8_t, kStringLength> block_i;
+    std::array<uint8_t, kStringLength> block_j;
+    uint64_t const max_length = n_ - std::max(i, j);
+    uint64_t lce = 0;
+    while (lce < max_length) {
+      size_t const length = std::min<uint64_t>(kStringLength, max_length - lce);
+      file_.read(block_i.data(), i + lce, i + lce + length);
+      file_.read(block_j.data(), j + lce, j + lce + length);
+      size_t const equal = std::mismatch(block_i.begin(), block_i.begin() + length,
+                                         block_j.begin()).first - block_i.begin();
+      lce += equal;
+      if (equal < length) {
+        break;
+      }
+    }
+    return lce;
+  }
+
+  /* Sorts the strings of consecutive positions in memory and writes them
+     to run files. Returns the strings with names of their own. */
+  std::vector<record> write_runs() {
+    size_t const batch_bytes = std::max<size_t>(opt_.ram_budget / 4, 2 * kStringLength);
+    std::vector<record> unique_strings;
+    std::vector<uint8_t> region;
+    std::vector<record> batch;
+    size_t first = 0;
+    while (first < sss_.size()) {
+      size_t last = first + 1;
+      while (last < sss_.size() && sss_[last] + kStringLength - sss_[first] <= batch_bytes) {
+        ++last;
+      }
+      size_t const region_begin = sss_[first];
+      size_t const region_end = std::min<size_t>(sss_[last - 1] + kStringLength, n_);
+      region.resize(region_end - region_begin);
+      file_.read(region.data(), region_begin, region_end);
+
+      batch.clear();
+      for (size_t k = first; k < last; ++k) {
+        record r;
+        r.index = k;
+        r.length = std::min<size_t>(kStringLength, n_ - sss_[k]);
+        std::memcpy(r.chars.data(), region.data() + (sss_[k] - region_begin), r.length);
+        std::memset(r.chars.data() + r.length, 0, kStringLength - r.length);
+        (has_unique_name(k) ? unique_strings : batch).push_back(r);
+      }
+      ips4o::sort(batch.begin(), batch.end(), less);
+
+      run_files_.push_back(opt_.tmp_dir + "/lce_external_" + std::to_string(::getpid()) +
+                           "_" + std::to_string(run_files_.size()) + ".run");
+      std::ofstream out(run_files_.back(), std::ios::binary | std::ios::trunc);
+      out.write(reinterpret_cast<char const*>(batch.data()), batch.size() * sizeof(record));
+      if (!out) {
+        throw std::runtime_error("Cannot write " + run_files_.back());
+      }
+      first = last;
+    }
+    return unique_strings;
+  }
+
+  /* Reads a run file in blocks. */
+  class run_reader {
+   public:
+    run_reader(std::string const& path, size_t const block_records)
+        : in_(path, std::ios::binary), buffer_(block_records) {
+      refill();
+    }
+
+    bool empty() const {
+      return pos_ == size_;
+    }
+
+    record const& front() const {
+      return buffer_[pos_];
+    }
+
+    void pop() {
+      if (++pos_ == size_) {
+        refill();
+      }
+    }
+
+   private:
+    std::ifstream in_;
+    std::vector<record> buffer_;
+    size_t pos_ = 0;
+    size_t size_ = 0;
+
+    void refill() {
+      in_.read(reinterpret_cast<char*>(buffer_.data()), buffer_.size() * sizeof(record));
+      size_ = in_.gcount() / sizeof(record);
+      pos_ = 0;
+    }
+  };
+
+  /* Merges the run files and names the strings. Equal strings get the same
+     name, names start at 1 and the reduced text ends with a 0 sentinel. */
+  std::vector<uint32_t> name_strings(std::vector<record>& unique_strings, uint32_t& max_rank) {
+    size_t const block_records = std::max<size_t>(
+        opt_.ram_budget / 4 / std::max<size_t>(run_files_.size(), 1) / sizeof(record), 1);
+    std::vector<run_reader> readers;
+    readers.reserve(run_files_.size());
+    for (auto const& path : run_files_) {
+      readers.emplace_back(path, block_records);
+    }
+    auto greater = [&](size_t const a, size_t const b) {
+      return less(readers[b].front(), readers[a].front());
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heap(greater);
+    for (size_t r = 0; r < readers.size(); ++r) {
+      if (!readers[r].empty()) {
+        heap.push(r);
+      }
+    }
+
+    std::vector<uint32_t> new_text(sss_.size() + 1, 0);
+    uint32_t rank = 0;
+    record previous;
+    bool first = true;
+    while (!heap.empty()) {
+      size_t const r = heap.top();
+      heap.pop();
+      record const& current = readers[r].front();
+      if (first || compare(previous, current) != 0) {
+        ++rank;
+      }
+      first = false;
+      previous = current;
+      new_text[current.index] = rank;
+      readers[r].pop();
+      if (!readers[r].empty()) {
+        heap.push(r);
+      }
+    }
+
+    // Strings with names of their own go to the end.
+    std::sort(unique_strings.begin(), unique_strings.end(), less);
+    for (record const& r : unique_strings) {
+      new_text[r.index] = ++rank;
+    }
+    max_rank = rank + 1;
+    return new_text;
+  }
+
+  void write_index(std::string const& index_path) {
+    {
+      phase_profiler::scope const phase("sss_construct");
+      compute_sync_set();
+    }
+
+    size_t const reduced_bytes = sss_.size() * (2 * sizeof(uint32_t) + 2 * sizeof(sss_type));
+    if (reduced_bytes > opt_.ram_budget) {
+      throw std::runtime_error("The reduced text needs " + std::to_string(reduced_bytes) +
+                               " bytes, which exceeds the RAM budget");
+    }
+
+    phase_profiler::scope sort_phase("string_sort");
+    std::vector<record> unique_strings = write_runs();
+    sort_phase.stop();
+    phase_profiler::scope rank_phase("rank");
+    uint32_t max_rank = 0;
+    std::vector<uint32_t> new_text = name_strings(unique_strings, max_rank);
+    for (auto const& path : run_files_) {
+      std::remove(path.c_str());
+    }
+    run_files_.clear();
+    rank_phase.stop();
+
+    serialization::array<sss_type> const sync_set(std::move(sss_));
+    typename lce_type::rmq_type const rmq(n_, sync_set.data(), sync_set.size(),
+                                          std::move(new_text), max_rank,
+                                          [this](uint64_t const i, uint64_t const j) {
+                                            return lce_in_file(i, j);
+                                          }, exec_);
+    phase_profiler::scope pred_phase("pred_construct");
+    typename lce_type::index_type const ind(sync_set, exec_);
+    pred_phase.stop();
+
+    phase_profiler::scope const write_phase("write");
+    serialization::writer out(index_path, lce_type::type_name());
+    out.begin_array(n_);
+    std::vector<uint8_t> buffer(
+        std::min<size_t>(n_, std::max<size_t>(opt_.ram_budget / 4, kStringLength)));
+    for (size_t from = 0; from < n_; from += buffer.size()) {
+      size_t const to = std::min(from + buffer.size(), n_);
+      file_.read(buffer.data(), from, to);
+      out.write_elements(buffer.data(), to - from);
+    }
+    out.write_array(sync_set);
+    ind.save(out);
+    rmq.save(out);
+  }
+};
+}  // namespace lce_test::par
+
+/******************************************************************************/
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * structs/lce_semi_synchronizing_sets.hpp
+ * lce_semi_synchronizing_sets_par.hpp
  *
  * Copyright (C) 2019 Alexander Herlez <alexander.herlez@tu-dortmund.de>
  * Copyright (C) 2019 Florian Kurpicz <florian.kurpicz@tu-dortmund.de>
@@ -9,133 +9,150 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <cmath>
 #include <memory>
+#include <span>
+#include <string>
 #include <tlx/define/likely.hpp>
 #include <vector>
 
+#include "util/execution.hpp"
 #include "util/lce_interface.hpp"
+#include "util/phase_profiler.hpp"
+#include "util/pread_file.hpp"
+#include "util/query_stats.hpp"
+#include "util/serialization.hpp"
 #include "util/successor/index_par.hpp"
 #include "util/util.hpp"
 #include "util_ssss_par/lce-rmq.hpp"
 #include "util_ssss_par/ssss_par.hpp"
 #include "util_ssss_par/sss_checker.hpp"
 
-#ifdef DETAILED_TIME
-#include <malloc_count.h>
-#endif
-
 namespace lce_test::par {
 __extension__ typedef unsigned __int128 uint128_t;
-/* This class stores a text as an array of characters and 
- * answers LCE-queries with the naive method. */
-template <uint64_t kTau = 1024>
+
+/* How a query is answered. scan_first compares up to 3 * tau characters
+ * before it looks at the synchronizing set, which is fast for short LCEs.
+ * successor_first looks up the next synchronizing positions first and only
+ * scans up to them, which is fast for long LCEs. adaptive counts the long
+ * LCEs of the last queries of each thread and switches between both. */
+enum class query_mode { scan_first, successor_first, adaptive };
+
+/* This class answers LCE-queries naively for short LCEs and with a string
+ * synchronizing set for long LCEs. The construction runs with the given
+ * execution policy (see util/execution.hpp). If hierarchical is set, long
+ * LCEs are answered with a hierarchy of string synchronizing sets instead of
+ * a suffix array of the reduced text (see util_ssss_par/sss_hierarchy.hpp).
+ * The data structure can be stored with save() and queried from a memory
+ * mapped file without copying with open_mmap(). */
+template <uint64_t kTau = 1024, query_mode t_mode = query_mode::scan_first,
+          typename Exec = execution::default_policy, bool hierarchical = false>
 class LceSemiSyncSetsPar : public LceDataStructure {
  public:
   using sss_type = uint64_t;
+  using index_type = stash::pred::index_par<serialization::array<sss_type>, sss_type, 7>;
+  using rmq_type = Lce_rmq_par<sss_type, kTau, hierarchical>;
+
+  // The adaptive mode decides after every kAdaptiveWindow queries of a thread.
+  static constexpr uint32_t kAdaptiveWindow = 1024;
+  // Two successor queries cost about as much as scanning this many characters.
+  static constexpr uint64_t kSuccessorCost = 4096;
+  // The number of data structures a thread keeps adaptive counters for
+  static constexpr size_t kAdaptiveSlots = 4;
 
  public:
-  LceSemiSyncSetsPar(std::vector<uint8_t> const& text, bool const print_ss_size)
-      : text_(text), text_length_in_bytes_(text_.size()) {
-#ifdef DETAILED_TIME
-    size_t mem_before = malloc_count_current();
-    malloc_count_reset_peak();
-    std::chrono::system_clock::time_point begin = std::chrono::system_clock::now();
-#endif
-
-    sync_set_ = string_synchronizing_set_par<kTau, sss_type>(text_);
-    //check_string_synchronizing_set(text, sync_set_);
-    //print_sss();
+  LceSemiSyncSetsPar(std::span<uint8_t const> const text, bool const print_ss_size,
+                     Exec const& exec = Exec())
+      : text_(text.data()), text_length_in_bytes_(text.size()) {
+    construct(print_ss_size, exec, [](size_t, size_t) {});
+  }
 
-#ifdef DETAILED_TIME
-    std::chrono::system_clock::time_point end = std::chrono::system_clock::now();
-    if (print_ss_size) {
-      std::cout << "sss_construct_time="
-                << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << " "
-                << "sss_construct_mem=" << (malloc_count_peak() - mem_before) << " "
-                << "sss_size=" << sync_set_.size() << " "
-                << "sss_repetetive=" << std::boolalpha << sync_set_.has_runs() << " "
-                << "sss_runs=" << sync_set_.num_runs() << " ";
-    }
-#endif
+  /* Reads the text from the file with one pread per thread. Each thread
+     starts to build the string synchronizing set on its part of the text as
+     soon as the part is read. The data structure owns the text. */
+  LceSemiSyncSetsPar(pread_file const& file, bool const print_ss_size,
+                     Exec const& exec = Exec())
+      : owned_text_(new uint8_t[file.size()]), text_(owned_text_.get()),
+        text_length_in_bytes_(file.size()) {
+    construct(print_ss_size, exec, [&](size_t const from, size_t const to) {
+      file.read(owned_text_.get() + from, from, to);
+    });
+  }
 
-#ifdef DETAILED_TIME
-    mem_before = malloc_count_current();
-    malloc_count_reset_peak();
-    begin = std::chrono::system_clock::now();
-#endif
+  /* Stores the text and the data structure in a file. */
+  void save(std::string const& path) const override {
+    serialization::writer out(path, type_name());
+    out.write_array(text_, text_length_in_bytes_);
+    out.write_array(sync_set_);
+    ind_->save(out);
+    lce_rmq_->save(out);
+  }
 
-    ind_ = std::make_unique<stash::pred::index_par<std::vector<sss_type>, sss_type, 7>>(sync_set_.get_sss());
+  /* Maps a file written by save(). The file has to be written by a data
+     structure with the same kTau and hierarchical. */
+  static std::unique_ptr<LceSemiSyncSetsPar> open_mmap(
+      std::string const& path, serialization::map_options const& opt = serialization::map_options()) {
+    serialization::reader in(path, type_name(), opt);
+    return std::unique_ptr<LceSemiSyncSetsPar>(new LceSemiSyncSetsPar(in));
+  }
 
-#ifdef DETAILED_TIME
-    end = std::chrono::system_clock::now();
-    if (print_ss_size) {
-      std::cout << "pred_construct_time="
-                << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << " "
-                << "pred_construct_mem=" << (malloc_count_peak() - mem_before) << " ";
-    }
-#endif
-    lce_rmq_ = std::make_unique<Lce_rmq_par<sss_type, kTau>>(text_.data(),
-                                                             text_length_in_bytes_,
-                                                             sync_set_);
+  /* Maps a file written by save() for texts that do not fit into memory.
+     Only the text stays on disk. Queries read the pages of the at most
+     3 * kTau long windows they scan without readahead. The rest of the data
+     structure is read into memory now. */
+  static std::unique_ptr<LceSemiSyncSetsPar> open_semi_external(std::string const& path) {
+    serialization::map_options opt;
+    opt.random = true;
+    std::unique_ptr<LceSemiSyncSetsPar> lce = open_mmap(path, opt);
+    size_t const text_end = lce->text_ + lce->text_length_in_bytes_ - lce->file_->data();
+    lce->file_->load(text_end, lce->file_->size());
+    return lce;
+  }
+
+  /* Identifies the layout of the files written by save(). */
+  static std::string type_name() {
+    return "LceSemiSyncSetsPar<" + std::to_string(kTau) + "," +
+           (hierarchical ? "hierarchical" : "rmq") + ">";
   }
 
   /* Answers the lce query for position i and j */
   inline uint64_t lce(uint64_t i, uint64_t j) {
     if (TLX_UNLIKELY(i == j)) {
+      query_stats::count(query_stats::equal);
       return text_length_in_bytes_ - i;
     }
     if (i > j) {
       std::swap(i, j);
     }
-
-    /* naive part */
-    uint64_t const sync_length = 3 * kTau;
-    uint64_t const max_length = std::min(sync_length, text_length_in_bytes_ - j);
-    uint64_t lce = 0;
-    for (; lce < 8; ++lce) {
-      if (TLX_UNLIKELY(lce >= max_length)) {
-        return max_length;
-      }
-      if (text_[i + lce] != text_[j + lce]) {
-        return lce;
-      }
+    if constexpr (t_mode == query_mode::scan_first) {
+      return lce_scan_first(i, j);
+    } else if constexpr (t_mode == query_mode::successor_first) {
+      return lce_successor_first(i, j);
+    } else {
+      adaptive_counter& counter = thread_counter();
+      uint64_t const lce = TLX_LIKELY(!counter.successor_first) ? lce_scan_first(i, j)
+                                                                : lce_successor_first(i, j);
+      counter.long_queries += (lce >= 3 * kTau);
+      counter.next_query();
+      return lce;
     }
+  }
 
-    lce = 0;
-    uint128_t const* const text_blocks_i =
-        reinterpret_cast<uint128_t const*>(text_.data() + i);
-    uint128_t const* const text_blocks_j =
-        reinterpret_cast<uint128_t const*>(text_.data() + j);
-    for (; lce < max_length / 16; ++lce) {
-      if (text_blocks_i[lce] != text_blocks_j[lce]) {
-        lce *= 16;
-        // The last block did not match. Here we compare its single characters
-        uint64_t lce_end = std::min(lce + 16, max_length);
-        for (; lce < lce_end; ++lce) {
-          if (text_[i + lce] != text_[j + lce]) {
-            return lce;
-          }
-        }
-        return lce;
-      }
+  /* min(lce(i, j), bound). Bounds below 3 * kTau are answered by a scan of
+     at most bound characters, without the synchronizing set. */
+  uint64_t lce_bounded(uint64_t i, uint64_t j, uint64_t const bound) {
+    if (bound >= 3 * kTau || TLX_UNLIKELY(i == j)) {
+      return std::min(lce(i, j), bound);
     }
-    lce *= 16;
-
-    /* strSync part */
-    uint64_t const i_ = suc(i + 1);
-    uint64_t const j_ = suc(j + 1);
-
-    uint64_t const i_diff = sync_set_[i_] - i;
-    uint64_t const j_diff = sync_set_[j_] - j;
-
-    if (i_diff == j_diff) {
-      return i_diff + lce_rmq_->lce(i_, j_);
-    } else {
-      return std::min(i_diff, j_diff) + 2 * kTau - 1;
+    if (i > j) {
+      std::swap(i, j);
     }
+    return count_scan(lce_scan(i, j, std::min(bound, text_length_in_bytes_ - j)));
   }
+
   char operator[](size_t i) {
     if (i > text_length_in_bytes_) {
       return '\00';
@@ -152,22 +169,67 @@ class LceSemiSyncSetsPar : public LceDataStructure {
     return text_length_in_bytes_;
   }
 
+  std::vector<space_component> space_breakdown() const {
+    std::vector<space_component> result = {
+        {"text", text_length_in_bytes_},
+        {"sync_set", sync_set_.size() * sizeof(sss_type)},
+        {"successor_index", ind_->size_in_bytes()}};
+    add_space(result, "rmq", lce_rmq_->space_breakdown());
+    return result;
+  }
+
   size_t getSyncSetSize() {
     return sync_set_.size();
   }
 
   std::vector<sss_type> getSyncSet() {
-    return sync_set_.get_sss();
+    return std::vector<sss_type>(sync_set_.begin(), sync_set_.end());
   }
 
   void print_sss() {
     std::ofstream of("/tmp/sss", std::ios::trunc);
-    for(auto i : sync_set_.get_sss()) {
+    for(auto i : sync_set_) {
       of << i << "\n";
     }
   }
 
  private:
+  LceSemiSyncSetsPar(serialization::reader& in) : file_(in.file()) {
+    serialization::array<uint8_t> const text = in.read_array<uint8_t>();
+    text_ = text.data();
+    text_length_in_bytes_ = text.size();
+    sync_set_ = in.read_array<sss_type>();
+    ind_ = std::make_unique<index_type>(in, sync_set_);
+    lce_rmq_ = std::make_unique<rmq_type>(in, text_, text_length_in_bytes_,
+                                          sync_set_.data(), sync_set_.size());
+  }
+
+  /* Builds the data structure for text_. load(from, to) is called before
+     text_[from, to) is read the first time (see ssss_par.hpp). */
+  template <typename Load>
+  void construct(bool const print_ss_size, Exec const& exec, Load const& load) {
+    phase_profiler::scope sss_phase("sss_construct");
+    std::span<uint8_t const> const text(text_, text_length_in_bytes_);
+    string_synchronizing_set_par<kTau, sss_type> sync_set(text, exec, load);
+    //check_string_synchronizing_set(text, sync_set);
+    //print_sss();
+    sss_phase.stop();
+    phase_profiler::global().set_value("sss_runs", sync_set.num_runs());
+
+    lce_rmq_ = std::make_unique<rmq_type>(text_, text_length_in_bytes_, sync_set, exec);
+    // Only the positions are needed for queries. Moving them keeps the
+    // buffer that lce_rmq_ points to.
+    sync_set_ = serialization::array<sss_type>(sync_set.release_sss());
+
+    {
+      phase_profiler::scope const pred_phase("pred_construct");
+      ind_ = std::make_unique<index_type>(sync_set_, exec);
+    }
+    if (print_ss_size) {
+      std::cout << "sync_set_size=" << getSyncSetSize() << " ";
+    }
+  }
+
   /* Finds the smallest element that is greater or equal to i
      Because s_ is ordered, that is equal to the 
      first element greater than i */
@@ -175,13 +237,166 @@ class LceSemiSyncSetsPar : public LceDataStructure {
     return ind_->successor(i).pos;
   }
 
+  /* Counts the long LCEs of a thread. After each window, the next window uses
+     successor_first, if skipping the scans of the long LCEs saves more than
+     the successor queries of the short LCEs cost. */
+  struct adaptive_counter {
+    // The id_ of the data structure, 0 for none
+    uint64_t owner = 0;
+    uint32_t queries = 0;
+    uint32_t long_queries = 0;
+    bool successor_first = false;
+
+    void next_query() {
+      if (++queries == kAdaptiveWindow) {
+        successor_first = long_queries * 3 * kTau > (queries - long_queries) * kSuccessorCost;
+        queries = 0;
+        long_queries = 0;
+      }
+    }
+  };
+
+  /* The adaptive counter of the calling thread for this data structure. A
+     thread keeps the counters of the last kAdaptiveSlots data structures it
+     queried, so that queries alternating between them keep their windows. */
+  adaptive_counter& thread_counter() const {
+    static thread_local std::array<adaptive_counter, kAdaptiveSlots> counters;
+    static thread_local size_t next_slot = 0;
+    for (adaptive_counter& c : counters) {
+      if (TLX_LIKELY(c.owner == id_)) {
+        return c;
+      }
+    }
+    adaptive_counter& c = counters[next_slot];
+    next_slot = (next_slot + 1) % kAdaptiveSlots;
+    c = adaptive_counter{id_};
+    return c;
+  }
+
+  static uint64_t next_id() {
+    static std::atomic<uint64_t> last_id{0};
+    return ++last_id;
+  }
+
+  /* Scans up to 3 * kTau characters and then uses the synchronizing set.
+     Requires i < j. */
+  inline uint64_t lce_scan_first(uint64_t const i, uint64_t const j) const {
+    uint64_t const sync_length = 3 * kTau;
+    uint64_t const max_length = std::min(sync_length, text_length_in_bytes_ - j);
+
+    /* naive part */
+    uint64_t const lce = lce_scan(i, j, max_length);
+    if (lce < sync_length) {
+      return count_scan(lce);
+    }
+
+    /* strSync part */
+    stash::pred::result const i_suc = ind_->successor(i + 1);
+    stash::pred::result const j_suc = ind_->successor(j + 1);
+    if (TLX_UNLIKELY(!i_suc.exists || !j_suc.exists)) {
+      query_stats::count(query_stats::scan_end);
+      return lce + lce_scan(i + lce, j + lce, text_length_in_bytes_ - j - lce);
+    }
+    uint64_t const i_diff = sync_set_[i_suc.pos] - i;
+    uint64_t const j_diff = sync_set_[j_suc.pos] - j;
+    return lce_sync(i_suc.pos, j_suc.pos, i_diff, j_diff);
+  }
+
+  /* Uses the synchronizing set first, so that the naive part is bounded by
+     the distance to the next synchronizing positions. Requires i < j. */
+  inline uint64_t lce_successor_first(uint64_t const i, uint64_t const j) const {
+    uint64_t const max_length = std::min(3 * kTau, text_length_in_bytes_ - j);
+    stash::pred::result const i_suc = ind_->successor(i + 1);
+    stash::pred::result const j_suc = ind_->successor(j + 1);
+    if (TLX_UNLIKELY(!i_suc.exists || !j_suc.exists)) {
+      // No synchronizing position follows, we can only scan to the end.
+      query_stats::count(query_stats::scan_end);
+      return lce_scan(i, j, text_length_in_bytes_ - j);
+    }
+    uint64_t const i_diff = sync_set_[i_suc.pos] - i;
+    uint64_t const j_diff = sync_set_[j_suc.pos] - j;
+
+    /* naive part */
+    // If the distances differ, the lce is less than min(i_diff, j_diff) + 2 * kTau.
+    uint64_t const scan_length = (i_diff == j_diff) ?
+      std::min(i_diff, max_length) :
+      std::min(std::min(i_diff, j_diff) + 2 * kTau - 1, max_length);
+    uint64_t const lce = lce_scan(i, j, scan_length);
+    if (lce < scan_length || lce == text_length_in_bytes_ - j) {
+      return count_scan(lce);
+    }
+    return lce_sync(i_suc.pos, j_suc.pos, i_diff, j_diff);
+  }
+
+  /* Counts a query that was answered by the naive part. */
+  static uint64_t count_scan(uint64_t const lce) {
+    query_stats::count((lce < 8) ? query_stats::scan_8 : query_stats::scan_block);
+    return lce;
+  }
+
+  /* Compares T[i, i + max_length) with T[j, j + max_length) naively and
+     returns the length of their longest common prefix */
+  inline uint64_t lce_scan(uint64_t const i, uint64_t const j,
+                           uint64_t const max_length) const {
+    uint64_t lce = 0;
+    for (; lce < 8; ++lce) {
+      if (TLX_UNLIKELY(lce >= max_length)) {
+        return max_length;
+      }
+      if (text_[i + lce] != text_[j + lce]) {
+        return lce;
+      }
+    }
+
+    lce = 0;
+    uint128_t const* const text_blocks_i =
+        reinterpret_cast<uint128_t const*>(text_ + i);
+    uint128_t const* const text_blocks_j =
+        reinterpret_cast<uint128_t const*>(text_ + j);
+    for (; lce < max_length / 16; ++lce) {
+      if (text_blocks_i[lce] != text_blocks_j[lce]) {
+        break;
+      }
+    }
+    lce *= 16;
+    // Compare the single characters of the mismatching block or the remainder.
+    uint64_t const lce_end = std::min(lce + 16, max_length);
+    for (; lce < lce_end; ++lce) {
+      if (text_[i + lce] != text_[j + lce]) {
+        return lce;
+      }
+    }
+    return lce;
+  }
+
+  /* Answers the lce query for text positions whose next synchronizing
+     positions are sync_set_[i_] = i + i_diff and sync_set_[j_] = j + j_diff.
+     The text between them must already be known to match. */
+  inline uint64_t lce_sync(sss_type const i_, sss_type const j_,
+                           uint64_t const i_diff, uint64_t const j_diff) const {
+    if (i_diff == j_diff) {
+      return i_diff + lce_rmq_->lce(i_, j_);
+    } else {
+      query_stats::count(query_stats::distance_mismatch);
+      return std::min(i_diff, j_diff) + 2 * kTau - 1;
+    }
+  }
+
  private:
-  std::vector<uint8_t> const& text_;
-  size_t const text_length_in_bytes_;
+  // The mapped file of a data structure that was opened with open_mmap().
+  std::shared_ptr<serialization::mapped_file> file_;
+  // The text, if it was read by the data structure.
+  std::unique_ptr<uint8_t[]> owned_text_;
+
+  uint8_t const* text_;
+  size_t text_length_in_bytes_;
+
+  std::unique_ptr<index_type> ind_;
+  serialization::array<sss_type> sync_set_;
+  std::unique_ptr<rmq_type> lce_rmq_;
 
-  std::unique_ptr<stash::pred::index_par<std::vector<sss_type>, sss_type, 7>> ind_;
-  string_synchronizing_set_par<kTau, sss_type> sync_set_;
-  std::unique_ptr<Lce_rmq_par<sss_type, kTau>> lce_rmq_;
+  // Identifies the adaptive counters of the data structure in the threads.
+  uint64_t id_ = next_id();
 };
 }  // namespace lce_test::par
 /******************************************************************************/
@@ -0,0 +1,141 @@
+/*******************************************************************************
+ * malloc_count/malloc_count.cpp
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include "malloc_count.h"
+
+#include <errno.h>
+#include <malloc.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstddef>
+
+// The allocator of glibc, which we forward to
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t num, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+}
+
+namespace {
+
+/* Every allocation and free updates the current count with one atomic
+ * operation, so the peak is exact for any number of threads. Both counters
+ * have cache lines of their own, since the peak is rarely written. */
+struct alignas(64) counter {
+  std::atomic<size_t> value{0};
+};
+
+counter current;
+counter peak;
+counter num_allocs;
+
+void on_alloc(void* const ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  size_t const size = ::malloc_usable_size(ptr);
+  size_t const now = current.value.fetch_add(size, std::memory_order_relaxed) + size;
+  num_allocs.value.fetch_add(1, std::memory_order_relaxed);
+  size_t old_peak = peak.value.load(std::memory_order_relaxed);
+  while (now > old_peak &&
+         !peak.value.compare_exchange_weak(old_peak, now, std::memory_order_relaxed)) { }
+}
+
+void on_free(void* const ptr) {
+  if (ptr != nullptr) {
+    current.value.fetch_sub(::malloc_usable_size(ptr), std::memory_order_relaxed);
+  }
+}
+
+void* aligned(size_t const alignment, size_t const size) {
+  void* const ptr = __libc_memalign(alignment, size);
+  on_alloc(ptr);
+  return ptr;
+}
+}  // namespace
+
+extern "C" {
+
+size_t malloc_count_current(void) {
+  return current.value.load(std::memory_order_relaxed);
+}
+
+size_t malloc_count_peak(void) {
+  return peak.value.load(std::memory_order_relaxed);
+}
+
+void malloc_count_reset_peak(void) {
+  peak.value.store(current.value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+size_t malloc_count_num_allocs(void) {
+  return num_allocs.value.load(std::memory_order_relaxed);
+}
+
+void* malloc(size_t const size) {
+  void* const ptr = __libc_malloc(size);
+  on_alloc(ptr);
+  return ptr;
+}
+
+void* calloc(size_t const num, size_t const size) {
+  void* const ptr = __libc_calloc(num, size);
+  on_alloc(ptr);
+  return ptr;
+}
+
+void* realloc(void* const ptr, size_t const size) {
+  size_t const old_size = (ptr != nullptr) ? ::malloc_usable_size(ptr) : 0;
+  void* const result = __libc_realloc(ptr, size);
+  if (result == nullptr && size > 0) {
+    // The old block is still there.
+    return nullptr;
+  }
+  current.value.fetch_sub(old_size, std::memory_order_relaxed);
+  on_alloc(result);
+  return result;
+}
+
+void free(void* const ptr) {
+  on_free(ptr);
+  __libc_free(ptr);
+}
+
+// The aligned allocations must be counted, too, since they are freed with free.
+void* memalign(size_t const alignment, size_t const size) {
+  return aligned(alignment, size);
+}
+
+void* aligned_alloc(size_t const alignment, size_t const size) {
+  return aligned(alignment, size);
+}
+
+int posix_memalign(void** const result, size_t const alignment, size_t const size) {
+  if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) {
+    return EINVAL;
+  }
+  void* const ptr = aligned(alignment, size);
+  if (ptr == nullptr && size > 0) {
+    return ENOMEM;
+  }
+  *result = ptr;
+  return 0;
+}
+
+void* valloc(size_t const size) {
+  return aligned(::sysconf(_SC_PAGESIZE), size);
+}
+
+void* pvalloc(size_t const size) {
+  size_t const page = ::sysconf(_SC_PAGESIZE);
+  return aligned(page, (size + page - 1) / page * page);
+}
+}  // extern "C"
+
+/******************************************************************************/
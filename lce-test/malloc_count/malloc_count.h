@@ -1,14 +1,36 @@
+/*******************************************************************************
+ * malloc_count/malloc_count.h
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
 #pragma once
 
+#include <stddef.h>
 
-int malloc_count_current() {
-    return 0;
-}
+/* A thread-safe replacement of malloc_count (extlib/malloc_count) with the
+ * same interface. malloc_count.cpp replaces malloc, free, and friends of
+ * glibc and counts the usable size of every block, so the counts are also
+ * correct when OpenMP threads allocate and free concurrently. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bytes that are allocated right now */
+size_t malloc_count_current(void);
+
+/* Largest value of malloc_count_current() since the start or the last
+   malloc_count_reset_peak() */
+size_t malloc_count_peak(void);
+
+/* Sets the peak to the current value. */
+void malloc_count_reset_peak(void);
+
+/* Number of allocations since the start */
+size_t malloc_count_num_allocs(void);
 
-int malloc_count_peak() {
-    return 0;
+#ifdef __cplusplus
 }
+#endif
 
-void malloc_count_reset_peak() {
-    return;
-}
\ No newline at end of file
+/******************************************************************************/
@@ -0,0 +1,185 @@
+/*******************************************************************************
+ * util/execution.hpp
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <utility>
+#include <vector>
+
+#include "timeline.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/* Execution policies for the construction of the data structures. A policy
+ * splits the work into num_threads() blocks and runs f(t, nt) for every block
+ * t in [0, nt) with for_each_block. The number of blocks is the same for every
+ * call, so per-block results of one phase can be used in the next phase.
+ * Each block is a span of the timeline (see timeline.hpp), named after the
+ * innermost span of the calling thread. If blocks throw, for_each_block
+ * throws the exception of the first of them after all blocks are done. */
+namespace lce_test::execution {
+
+/* Runs block t of f as a span of the timeline. */
+template <typename F>
+void run_block(char const* const name, F& f, int const t, int const nt) {
+  timeline::span const block(name, t);
+  f(t, nt);
+}
+
+/* The exceptions of the blocks of a parallel region. An exception must not
+ * leave an OpenMP parallel region (or a job of a thread pool), since that
+ * calls std::terminate. Hence, every block catches its own, and rethrow()
+ * throws the one of the first failed block after the region. Long blocks
+ * can check failed() to stop early. */
+class block_errors {
+ public:
+  explicit block_errors(int const nt) : errors_(nt) {}
+
+  template <typename F>
+  void run(int const t, F&& f) noexcept {
+    try {
+      f();
+    } catch (...) {
+      errors_[t] = std::current_exception();
+      failed_.store(true, std::memory_order_relaxed);
+    }
+  }
+
+  bool failed() const {
+    return failed_.load(std::memory_order_relaxed);
+  }
+
+  void rethrow() const {
+    for (std::exception_ptr const& error : errors_) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+  }
+
+ private:
+  std::vector<std::exception_ptr> errors_;
+  std::atomic<bool> failed_ = false;
+};
+
+/* The name of the blocks of a parallel region that starts now */
+inline char const* block_name() {
+  char const* const name = timeline::current();
+  return (name != nullptr) ? name : "parallel";
+}
+
+/* Runs everything on the calling thread. */
+class sequential {
+ public:
+  static constexpr bool uses_openmp = false;
+
+  int num_threads() const {
+    return 1;
+  }
+
+  template <typename F>
+  void for_each_block(F&& f) const {
+    run_block(block_name(), f, 0, 1);
+  }
+};
+
+#ifdef _OPENMP
+/* Runs the blocks in an OpenMP parallel region. If OpenMP spawns less
+ * threads than requested, a thread works on multiple blocks. */
+class openmp {
+ public:
+  static constexpr bool uses_openmp = true;
+
+  explicit openmp(int const threads = omp_get_max_threads())
+      : threads_(std::max(threads, 1)) {}
+
+  int num_threads() const {
+    return threads_;
+  }
+
+  template <typename F>
+  void for_each_block(F&& f) const {
+    int const nt = threads_;
+    char const* const name = block_name();
+    block_errors errors(nt);
+#pragma omp parallel num_threads(nt)
+    {
+      for (int t = omp_get_thread_num(); t < nt; t += omp_get_num_threads()) {
+        errors.run(t, [&] { run_block(name, f, t, nt); });
+      }
+    }
+    errors.rethrow();
+  }
+
+ private:
+  int threads_;
+};
+#endif
+
+/* Runs the blocks as jobs of an executor with the interface of
+ * tlx::ThreadPool, i.e., size(), enqueue(job) and loop_until_empty(). */
+template <typename Executor>
+class custom {
+ public:
+  static constexpr bool uses_openmp = false;
+
+  explicit custom(Executor& executor) : executor_(&executor) {}
+
+  int num_threads() const {
+    return std::max(static_cast<int>(executor_->size()), 1);
+  }
+
+  template <typename F>
+  void for_each_block(F&& f) const {
+    int const nt = num_threads();
+    char const* const name = block_name();
+    block_errors errors(nt);
+    for (int t = 0; t < nt; ++t) {
+      executor_->enqueue([&f, &errors, name, t, nt]() {
+        errors.run(t, [&] { run_block(name, f, t, nt); });
+      });
+    }
+    executor_->loop_until_empty();
+    errors.rethrow();
+  }
+
+ private:
+  Executor* executor_;
+};
+
+#ifdef _OPENMP
+using default_policy = openmp;
+#else
+using default_policy = sequential;
+#endif
+
+/* Returns the range [begin, end) of block t, if [0, n) is split into nt
+ * blocks. The last block also gets the remainder. */
+inline std::pair<size_t, size_t> block_range(size_t const n, int const t,
+                                             int const nt) {
+  size_t const size_per_block = n / nt;
+  return {t * size_per_block, (t == nt - 1) ? n : (t + 1) * size_per_block};
+}
+
+/* Calls f(i) for all i in [0, n). */
+template <typename Exec, typename F>
+void parallel_for(Exec const& exec, size_t const n, F&& f) {
+  exec.for_each_block([&](int const t, int const nt) {
+    auto const [begin, end] = block_range(n, t, nt);
+    for (size_t i = begin; i < end; ++i) {
+      f(i);
+    }
+  });
+}
+}  // namespace lce_test::execution
+
+/******************************************************************************/
@@ -0,0 +1,48 @@
+/*******************************************************************************
+ * util/io_stats.hpp
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <sys/resource.h>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+namespace lce_test {
+
+/* The I/O of the process so far: major page faults, i.e., pages of mapped
+ * files that had to be read from storage, and the bytes that were read from
+ * storage (read_bytes of /proc/self/io, 0 if it is not available). Pages
+ * that are in the page cache cause no I/O. */
+struct io_stats {
+  uint64_t major_faults = 0;
+  uint64_t read_bytes = 0;
+
+  static io_stats now() {
+    io_stats result;
+    struct rusage usage;
+    if (::getrusage(RUSAGE_SELF, &usage) == 0) {
+      result.major_faults = usage.ru_majflt;
+    }
+    std::ifstream io("/proc/self/io");
+    std::string key;
+    uint64_t value;
+    while (io >> key >> value) {
+      if (key == "read_bytes:") {
+        result.read_bytes = value;
+      }
+    }
+    return result;
+  }
+
+  io_stats operator-(io_stats const& other) const {
+    return io_stats{major_faults - other.major_faults, read_bytes - other.read_bytes};
+  }
+};
+}  // namespace lce_test
+
+/******************************************************************************/
@@ -0,0 +1,105 @@
+/*******************************************************************************
+ * util/latency_histogram.hpp
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace lce_test {
+
+/* A histogram of latencies in ns in the style of HdrHistogram: values below
+ * 2^kSubBits are counted exactly, larger values in buckets whose width is
+ * 2^-(kSubBits-1) of their value. Hence, percentiles have a relative error of
+ * less than 1%, and adding a value costs a few instructions and no
+ * allocation. */
+class latency_histogram {
+ public:
+  static constexpr uint32_t kSubBits = 8;
+  static constexpr size_t kHalf = size_t{1} << (kSubBits - 1);
+  static constexpr size_t kNumBuckets = (64 - kSubBits + 2) * kHalf;
+
+  void add(uint64_t const ns) {
+    ++buckets_[index(ns)];
+    ++count_;
+    sum_ += ns;
+    min_ = std::min(min_, ns);
+    max_ = std::max(max_, ns);
+  }
+
+  void merge(latency_histogram const& other) {
+    for (size_t b = 0; b < kNumBuckets; ++b) {
+      buckets_[b] += other.buckets_[b];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+  }
+
+  uint64_t count() const {
+    return count_;
+  }
+
+  uint64_t min() const {
+    return (count_ > 0) ? min_ : 0;
+  }
+
+  uint64_t max() const {
+    return max_;
+  }
+
+  double avg() const {
+    return (count_ > 0) ? static_cast<double>(sum_) / count_ : 0;
+  }
+
+  /* The latency that a share q of the values does not exceed, i.e., the
+     largest value of the bucket of the value of rank ceil(q * count). */
+  uint64_t percentile(double const q) const {
+    if (count_ == 0) {
+      return 0;
+    }
+    uint64_t const rank = std::clamp<uint64_t>(std::ceil(q * count_), 1, count_);
+    uint64_t seen = 0;
+    for (size_t b = 0; b < kNumBuckets; ++b) {
+      seen += buckets_[b];
+      if (seen >= rank) {
+        return std::clamp(highest_value(b), min_, max_);
+      }
+    }
+    return max_;
+  }
+
+ private:
+  std::array<uint64_t, kNumBuckets> buckets_ = {};
+  uint64_t count_ = 0;
+  uint64_t sum_ = 0;
+  uint64_t min_ = std::numeric_limits<uint64_t>::max();
+  uint64_t max_ = 0;
+
+  /* Values with shift e > 0 are stored as their kSubBits most significant
+     bits, which are in [kHalf, 2 * kHalf). */
+  static size_t index(uint64_t const value) {
+    uint32_t const shift = std::max<int32_t>(std::bit_width(value) - kSubBits, 0);
+    return shift * kHalf + (value >> shift);
+  }
+
+  static uint64_t highest_value(size_t const b) {
+    if (b < 2 * kHalf) {
+      return b;
+    }
+    uint32_t const shift = b / kHalf - 1;
+    uint64_t const mantissa = b - shift * kHalf;
+    return ((mantissa + 1) << shift) - 1;
+  }
+};
+}  // namespace lce_test
+
+/******************************************************************************/
@@ -8,16 +8,50 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/* A part of a data structure and the bytes it takes. Parts of nested data
+ * structures are named "outer/inner". */
+struct space_component {
+  std::string name;
+  uint64_t bytes;
+};
+
+/* Appends the parts of a nested data structure with the prefix "name/". */
+inline void add_space(std::vector<space_component>& result, std::string const& name,
+                      std::vector<space_component> const& parts) {
+  for (auto const& part : parts) {
+    result.push_back({name + "/" + part.name, part.bytes});
+  }
+}
 
 class LceDataStructure {
 public:
   virtual ~LceDataStructure() = 0;
   virtual uint64_t lce(const uint64_t i, const uint64_t j) = 0;
+  /* min(lce(i, j), bound). Data structures that scan the text override it,
+     so that they compare at most bound characters. */
+  virtual uint64_t lce_bounded(const uint64_t i, const uint64_t j, const uint64_t bound) {
+    return std::min(lce(i, j), bound);
+  }
   //virtual char getChar(const uint64_t i) = 0;
   virtual char operator[](const uint64_t i) = 0;
   virtual int isSmallerSuffix(const uint64_t i, const uint64_t j) = 0;
+  // The length of the text, not the size of the data structure
   virtual uint64_t getSizeInBytes() = 0;
+  /* The parts of the data structure and their sizes in bytes, including
+     the text if the data structure needs it for queries. Memory that is
+     shared with the caller or mapped from a file is counted, too. */
+  virtual std::vector<space_component> space_breakdown() const = 0;
+  /* Stores the data structure in a file that can be memory mapped with the
+     open_mmap() function of the data structure. */
+  virtual void save(std::string const&) const {
+    throw std::runtime_error("This LCE data structure cannot be saved");
+  }
 }; // class LceDataStructure
 
 LceDataStructure::~LceDataStructure() { }
@@ -0,0 +1,188 @@
+/*******************************************************************************
+ * util/lce_server_protocol.hpp
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace lce_test::server {
+
+/* The protocol of lce_server. A client sends a request_header followed by
+ * count queries (or, for op::reload, count characters of a path). The server
+ * answers with a response_header followed by count results. All values are
+ * in host byte order, since client and server run on the same machine. */
+constexpr uint32_t kMagic = 0x4c434531;  // "LCE1"
+// The server closes connections that send larger requests. It answers an
+// unknown operation with status::bad_request and closes the connection.
+constexpr uint64_t kMaxBatch = uint64_t{1} << 24;
+
+enum class op : uint32_t {
+  lce = 0,      // lce(i, j)
+  compare = 1,  // 1 if the suffix i is smaller than the suffix j, else 0
+  bounded = 2,  // min(lce(i, j), bound), scans at most bound characters if possible
+  stats = 3,    // The latency stats of all batches so far (see stats_result)
+  reload = 4    // Replaces the index by the one of the path
+};
+
+enum class status : uint32_t {
+  ok = 0,
+  bad_request = 1,
+  failed = 2
+};
+
+struct request_header {
+  uint32_t magic = kMagic;
+  op operation = op::lce;
+  uint64_t count = 0;
+};
+
+struct query {
+  uint64_t i = 0;
+  uint64_t j = 0;
+  uint64_t bound = 0;
+};
+
+struct response_header {
+  status result = status::ok;
+  uint32_t reserved = 0;
+  uint64_t count = 0;
+  // Time the server needed for the batch
+  uint64_t server_ns = 0;
+  // Number of the index that answered the batch, increased by every reload
+  uint64_t generation = 0;
+};
+
+/* The results of op::stats in this order */
+enum stats_result : size_t {
+  kBatches = 0,
+  kQueries,
+  kTotalNs,
+  kMaxNs,
+  kNumStats
+};
+
+/* Writes or reads exactly size bytes. Returns false if the connection was
+   closed. */
+inline bool write_all(int const fd, void const* const data, size_t size) {
+  char const* ptr = static_cast<char const*>(data);
+  while (size > 0) {
+    ssize_t const bytes = ::send(fd, ptr, size, MSG_NOSIGNAL);
+    if (bytes < 0 && errno == EINTR) {
+      continue;
+    }
+    if (bytes <= 0) {
+      return false;
+    }
+    ptr += bytes;
+    size -= bytes;
+  }
+  return true;
+}
+
+inline bool read_all(int const fd, void* const data, size_t size) {
+  char* ptr = static_cast<char*>(data);
+  while (size > 0) {
+    ssize_t const bytes = ::recv(fd, ptr, size, 0);
+    if (bytes < 0 && errno == EINTR) {
+      continue;
+    }
+    if (bytes <= 0) {
+      return false;
+    }
+    ptr += bytes;
+    size -= bytes;
+  }
+  return true;
+}
+
+/* A connection to lce_server. Send many queries per call, since every call
+ * is a round trip. */
+class lce_client {
+ public:
+  explicit lce_client(std::string const& socket_path) {
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(addr.sun_path)) {
+      throw std::invalid_argument("The socket path is too long");
+    }
+    std::memcpy(addr.sun_path, socket_path.c_str(), socket_path.size() + 1);
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd_ < 0 || ::connect(fd_, reinterpret_cast<sockaddr const*>(&addr), sizeof(addr)) != 0) {
+      if (fd_ >= 0) {
+        ::close(fd_);
+      }
+      throw std::runtime_error("Cannot connect to " + socket_path);
+    }
+  }
+
+  lce_client(lce_client const&) = delete;
+  lce_client& operator=(lce_client const&) = delete;
+
+  ~lce_client() {
+    ::close(fd_);
+  }
+
+  std::vector<uint64_t> lce(std::span<query const> const queries) {
+    return send(op::lce, queries.data(), queries.size_bytes(), queries.size());
+  }
+
+  std::vector<uint64_t> compare(std::span<query const> const queries) {
+    return send(op::compare, queries.data(), queries.size_bytes(), queries.size());
+  }
+
+  std::vector<uint64_t> bounded(std::span<query const> const queries) {
+    return send(op::bounded, queries.data(), queries.size_bytes(), queries.size());
+  }
+
+  std::vector<uint64_t> stats() {
+    return send(op::stats, nullptr, 0, 0);
+  }
+
+  /* Lets the server replace its index. Queries that are running keep the
+     old one. */
+  void reload(std::string const& path) {
+    send(op::reload, path.data(), path.size(), path.size());
+  }
+
+  /* The header of the last response */
+  response_header const& last_response() const {
+    return response_;
+  }
+
+ private:
+  int fd_ = -1;
+  response_header response_;
+
+  std::vector<uint64_t> send(op const operation, void const* const payload, size_t const bytes,
+                             uint64_t const count) {
+    request_header const header{kMagic, operation, count};
+    if (!write_all(fd_, &header, sizeof(header)) || !write_all(fd_, payload, bytes) ||
+        !read_all(fd_, &response_, sizeof(response_))) {
+      throw std::runtime_error("The connection to the LCE server was closed");
+    }
+    std::vector<uint64_t> result(response_.count);
+    if (!read_all(fd_, result.data(), result.size() * sizeof(uint64_t))) {
+      throw std::runtime_error("The connection to the LCE server was closed");
+    }
+    if (response_.result != status::ok) {
+      throw std::runtime_error("The LCE server could not answer the request");
+    }
+    return result;
+  }
+};
+}  // namespace lce_test::server
+
+/******************************************************************************/
@@ -0,0 +1,95 @@
+/*******************************************************************************
+ * util/mpmc_queue.hpp
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+
+namespace lce_test {
+
+/* A bounded lock-free queue for many producers and many consumers (Dmitry
+ * Vyukov's ring buffer). Every slot has a sequence number that tells whether
+ * it can be written or read in the current lap. The capacity is rounded up
+ * to a power of two. */
+template <typename T>
+class mpmc_queue {
+ public:
+  explicit mpmc_queue(size_t const capacity)
+      : mask_(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1),
+        slots_(std::make_unique<slot[]>(mask_ + 1)) {
+    for (size_t k = 0; k <= mask_; ++k) {
+      slots_[k].sequence.store(k, std::memory_order_relaxed);
+    }
+  }
+
+  /* Returns false if the queue is full. */
+  bool try_push(T const& value) {
+    size_t pos = tail_.load(std::memory_order_relaxed);
+    while (true) {
+      slot& s = slots_[pos & mask_];
+      size_t const sequence = s.sequence.load(std::memory_order_acquire);
+      intptr_t const diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          s.value = value;
+          s.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /* Returns nothing if the queue is empty. */
+  std::optional<T> try_pop() {
+    size_t pos = head_.load(std::memory_order_relaxed);
+    while (true) {
+      slot& s = slots_[pos & mask_];
+      size_t const sequence = s.sequence.load(std::memory_order_acquire);
+      intptr_t const diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          T value = std::move(s.value);
+          s.sequence.store(pos + mask_ + 1, std::memory_order_release);
+          return value;
+        }
+      } else if (diff < 0) {
+        return std::nullopt;
+      } else {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  size_t capacity() const {
+    return mask_ + 1;
+  }
+
+ private:
+  struct slot {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  static constexpr size_t kCacheLine = 64;
+
+  size_t const mask_;
+  std::unique_ptr<slot[]> const slots_;
+  alignas(kCacheLine) std::atomic<size_t> head_ = 0;
+  alignas(kCacheLine) std::atomic<size_t> tail_ = 0;
+};
+}  // namespace lce_test
+
+/******************************************************************************/
@@ -0,0 +1,202 @@
+/*******************************************************************************
+ * util/perf_counters.hpp
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace lce_test {
+
+/* Counts of the hardware events of perf_counters. A counter that could not
+ * be opened is not valid and not printed. */
+struct perf_sample {
+  static constexpr size_t kNumEvents = 5;
+  static constexpr std::array<char const*, kNumEvents> kNames = {
+    "cycles", "instructions", "llc_misses", "dtlb_misses", "branch_misses"};
+
+  std::array<double, kNumEvents> values = {};
+  std::array<bool, kNumEvents> valid = {};
+
+  perf_sample& operator+=(perf_sample const& other) {
+    for (size_t e = 0; e < kNumEvents; ++e) {
+      values[e] += other.values[e];
+      valid[e] = valid[e] || other.valid[e];
+    }
+    return *this;
+  }
+
+  perf_sample operator-(perf_sample const& other) const {
+    perf_sample result = *this;
+    for (size_t e = 0; e < kNumEvents; ++e) {
+      result.values[e] -= other.values[e];
+    }
+    return result;
+  }
+
+  /* Prints "<prefix><name>=<value / divisor> " for the valid counters. */
+  void print(std::ostream& out, std::string const& prefix, double const divisor = 1) const {
+    for (size_t e = 0; e < kNumEvents; ++e) {
+      if (valid[e]) {
+        out << prefix << kNames[e] << "=" << values[e] / divisor << " ";
+      }
+    }
+  }
+};
+
+/* Hardware performance counters (via perf_event_open) for cycles,
+ * instructions, last level cache misses, data TLB misses, and branch misses.
+ * Only user space is counted, so it works with perf_event_paranoid <= 2.
+ * Every thread of the OpenMP team (of omp_get_max_threads() threads when the
+ * counters are created) gets counters of its own, which are summed up, so
+ * parallel constructions are counted completely. Other threads are not
+ * counted. If an event is not supported (e.g., in a VM or without
+ * permission) for some thread, its counter is missing, and if the counters
+ * are disabled, all of them are. When the kernel multiplexes the counters,
+ * the counts are scaled to the whole time. */
+class perf_counters {
+ public:
+  explicit perf_counters(bool const enabled = true) {
+    if (!enabled) {
+      return;
+    }
+#ifdef _OPENMP
+    thread_fds none;
+    none.fill(-1);
+    fds_.resize(omp_get_max_threads(), none);
+#pragma omp parallel num_threads(fds_.size())
+    fds_[omp_get_thread_num()] = open_thread();
+#else
+    fds_.push_back(open_thread());
+#endif
+    for (auto const& thread : fds_) {
+      for (int const fd : thread) {
+        if (fd >= 0) {
+          ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+          ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+      }
+    }
+  }
+
+  perf_counters(perf_counters const&) = delete;
+  perf_counters& operator=(perf_counters const&) = delete;
+
+  ~perf_counters() {
+    for (auto const& thread : fds_) {
+      for (int const fd : thread) {
+        if (fd >= 0) {
+          ::close(fd);
+        }
+      }
+    }
+  }
+
+  /* Whether at least one counter works */
+  bool available() const {
+    return read().valid != std::array<bool, perf_sample::kNumEvents>{};
+  }
+
+  /* The counts of all threads since the construction. Differences of two
+     reads are the counts of the code in between. */
+  perf_sample read() const {
+    perf_sample result;
+    for (size_t e = 0; e < perf_sample::kNumEvents; ++e) {
+      result.valid[e] = !fds_.empty();
+      for (auto const& thread : fds_) {
+        // value, time enabled, time running
+        uint64_t data[3];
+        if (thread[e] < 0 || ::read(thread[e], data, sizeof(data)) != sizeof(data)) {
+          result.valid[e] = false;
+          break;
+        }
+        result.values[e] += (data[2] > 0) ? double(data[0]) * data[1] / data[2] : 0;
+      }
+      if (!result.valid[e]) {
+        result.values[e] = 0;
+      }
+    }
+    return result;
+  }
+
+  /* Adds the counts from its construction to its destruction (or stop())
+     to a sample. */
+  class phase {
+   public:
+    phase(perf_counters const& counters, perf_sample& sum)
+        : counters_(&counters), sum_(&sum), begin_(counters.read()) { }
+
+    phase(phase const&) = delete;
+    phase& operator=(phase const&) = delete;
+
+    ~phase() {
+      stop();
+    }
+
+    void stop() {
+      if (counters_ != nullptr) {
+        *sum_ += counters_->read() - begin_;
+        counters_ = nullptr;
+      }
+    }
+
+   private:
+    perf_counters const* counters_;
+    perf_sample* sum_;
+    perf_sample begin_;
+  };
+
+ private:
+  using thread_fds = std::array<int, perf_sample::kNumEvents>;
+
+  // The counters of every thread, -1 if they could not be opened
+  std::vector<thread_fds> fds_;
+
+  /* Opens the counters of the calling thread. */
+  static thread_fds open_thread() {
+    thread_fds fds;
+    fds[0] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    fds[1] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    fds[2] = open(PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_LL));
+    if (fds[2] < 0) {
+      fds[2] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    }
+    fds[3] = open(PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_DTLB));
+    fds[4] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    return fds;
+  }
+
+  static uint64_t cache_miss(uint64_t const cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  }
+
+  static int open(uint32_t const type, uint64_t const config) {
+    perf_event_attr attr = {};
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+};
+}  // namespace lce_test
+
+/******************************************************************************/
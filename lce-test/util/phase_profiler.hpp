@@ -0,0 +1,229 @@
+/*******************************************************************************
+ * util/phase_profiler.hpp
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <time.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "perf_counters.hpp"
+#include "timeline.hpp"
+
+namespace lce_test {
+
+/* Collects the wall time, the CPU time of all threads of the process, and
+ * the change of the allocated memory of the phases of the constructions.
+ * A phase is measured by a scope object until its destruction or stop():
+ *
+ *   { phase_profiler::scope const phase("sa_construct"); ... }
+ *
+ * Phases with the same name are summed up, so several runs of a construction
+ * give their total (see phase::count). A phase costs four clock reads (and
+ * two reads of the hardware counters, if they are set), which is negligible
+ * for construction phases, so the profiler is always on. The
+ * memory is only measured if a counter is set with set_memory_counter(),
+ * e.g., malloc_count_current() of the benchmarks, and the hardware events
+ * only if counters are set with set_perf_counters(). Phases are also spans
+ * of the timeline (see timeline.hpp). */
+class phase_profiler {
+ public:
+  struct phase {
+    std::string name;
+    // Nesting depth of the first occurrence
+    uint32_t depth = 0;
+    uint64_t count = 0;
+    uint64_t wall_ns = 0;
+    uint64_t cpu_ns = 0;
+    int64_t mem_delta = 0;
+    perf_sample perf;
+  };
+
+  using memory_counter = int64_t (*)();
+
+  /* The profiler that the data structures report to */
+  static phase_profiler& global() {
+    static phase_profiler profiler;
+    return profiler;
+  }
+
+  void set_memory_counter(memory_counter const counter) {
+    memory_counter_ = counter;
+  }
+
+  /* The counters must live until they are replaced, e.g., by nullptr. */
+  void set_perf_counters(perf_counters const* const counters) {
+    perf_counters_ = counters;
+  }
+
+  /* Measures the phase name from its construction to its destruction. */
+  class scope {
+   public:
+    explicit scope(char const* const name, phase_profiler& profiler = global())
+        : profiler_(profiler), name_(name), depth_(depth()++),
+          mem_before_(profiler.memory()), perf_before_(profiler.perf()), cpu_before_(cpu_time()),
+          wall_before_(std::chrono::steady_clock::now()), span_(name) { }
+
+    scope(scope const&) = delete;
+    scope& operator=(scope const&) = delete;
+
+    ~scope() {
+      stop();
+    }
+
+    /* Ends the phase before the end of the scope. */
+    void stop() {
+      if (stopped_) {
+        return;
+      }
+      auto const wall_after = std::chrono::steady_clock::now();
+      uint64_t const cpu_after = cpu_time();
+      perf_sample const perf_after = profiler_.perf();
+      span_.stop();
+      --depth();
+      profiler_.add(name_, depth_,
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(wall_after - wall_before_).count(),
+                    cpu_after - cpu_before_, profiler_.memory() - mem_before_,
+                    perf_after - perf_before_);
+      stopped_ = true;
+    }
+
+   private:
+    bool stopped_ = false;
+    phase_profiler& profiler_;
+    char const* const name_;
+    uint32_t const depth_;
+    int64_t const mem_before_;
+    perf_sample const perf_before_;
+    uint64_t const cpu_before_;
+    std::chrono::steady_clock::time_point const wall_before_;
+    timeline::span span_;
+
+    static uint32_t& depth() {
+      thread_local uint32_t depth = 0;
+      return depth;
+    }
+  };
+
+  /* Records a value that belongs to the phases, e.g., the size of a string
+     synchronizing set. A later value of the same name replaces it. */
+  void set_value(std::string const& name, uint64_t const value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& v : values_) {
+      if (v.first == name) {
+        v.second = value;
+        return;
+      }
+    }
+    values_.emplace_back(name, value);
+  }
+
+  /* The phases in the order of their first end */
+  std::vector<phase> phases() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return phases_;
+  }
+
+  std::vector<std::pair<std::string, uint64_t>> values() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return values_;
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    phases_.clear();
+    values_.clear();
+  }
+
+  /* Prints "<name>_time=<ms> <name>_cpu_time=<ms> <name>_mem=<bytes> " and
+     the valid hardware events, e.g., "<name>_cycles=<count> ", for every
+     phase, divided by runs, and "<name>=<value> " for every value. */
+  void print(std::ostream& out, uint64_t const runs = 1) const {
+    for (auto const& p : phases()) {
+      out << p.name << "_time=" << p.wall_ns / 1e6 / runs << " "
+          << p.name << "_cpu_time=" << p.cpu_ns / 1e6 / runs << " "
+          << p.name << "_mem=" << p.mem_delta / static_cast<int64_t>(runs) << " ";
+      p.perf.print(out, p.name + "_", runs);
+    }
+    for (auto const& [name, value] : values()) {
+      out << name << "=" << value << " ";
+    }
+  }
+
+  /* Writes the phases and values as a JSON object. Times are in ns. */
+  void write_json(std::ostream& out) const {
+    out << "{\"phases\":[";
+    bool first = true;
+    for (auto const& p : phases()) {
+      out << (first ? "" : ",") << "{\"name\":\"" << p.name << "\",\"depth\":" << p.depth
+          << ",\"count\":" << p.count << ",\"wall_ns\":" << p.wall_ns
+          << ",\"cpu_ns\":" << p.cpu_ns << ",\"mem_delta\":" << p.mem_delta;
+      for (size_t e = 0; e < perf_sample::kNumEvents; ++e) {
+        if (p.perf.valid[e]) {
+          out << ",\"" << perf_sample::kNames[e] << "\":" << p.perf.values[e];
+        }
+      }
+      out << "}";
+      first = false;
+    }
+    out << "],\"values\":{";
+    first = true;
+    for (auto const& [name, value] : values()) {
+      out << (first ? "" : ",") << "\"" << name << "\":" << value;
+      first = false;
+    }
+    out << "}}";
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::atomic<memory_counter> memory_counter_ = nullptr;
+  std::atomic<perf_counters const*> perf_counters_ = nullptr;
+  std::vector<phase> phases_;
+  std::vector<std::pair<std::string, uint64_t>> values_;
+
+  int64_t memory() const {
+    memory_counter const counter = memory_counter_;
+    return (counter != nullptr) ? counter() : 0;
+  }
+
+  perf_sample perf() const {
+    perf_counters const* const counters = perf_counters_;
+    return (counters != nullptr) ? counters->read() : perf_sample();
+  }
+
+  static uint64_t cpu_time() {
+    timespec ts;
+    ::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+  }
+
+  void add(char const* const name, uint32_t const depth, uint64_t const wall_ns,
+           uint64_t const cpu_ns, int64_t const mem_delta, perf_sample const& perf) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& p : phases_) {
+      if (p.name == name) {
+        ++p.count;
+        p.wall_ns += wall_ns;
+        p.cpu_ns += cpu_ns;
+        p.mem_delta += mem_delta;
+        p.perf += perf;
+        return;
+      }
+    }
+    phases_.push_back(phase{name, depth, 1, wall_ns, cpu_ns, mem_delta, perf});
+  }
+};
+}  // namespace lce_test
+
+/******************************************************************************/
@@ -0,0 +1,75 @@
+/*******************************************************************************
+ * util/pread_file.hpp
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace lce_test {
+
+/* A file that is read with pread, so that several threads can read different
+ * parts of it at the same time. */
+class pread_file {
+ public:
+  /* Opens the file. If prefix_size > 0, only its first prefix_size bytes are
+     used. */
+  explicit pread_file(std::string const& path, size_t const prefix_size = 0) {
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+      throw std::runtime_error("Cannot open " + path);
+    }
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+      ::close(fd_);
+      throw std::runtime_error("Cannot stat " + path);
+    }
+    size_ = st.st_size;
+    if (prefix_size > 0) {
+      size_ = std::min<size_t>(prefix_size, size_);
+    }
+  }
+
+  pread_file(pread_file const&) = delete;
+  pread_file& operator=(pread_file const&) = delete;
+
+  ~pread_file() {
+    ::close(fd_);
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  /* Reads the bytes [from, to) of the file to buffer[0, to - from). */
+  void read(uint8_t* buffer, size_t from, size_t const to) const {
+    while (from < to) {
+      ssize_t const bytes = ::pread(fd_, buffer, to - from, from);
+      if (bytes < 0 && errno == EINTR) {
+        continue;
+      }
+      if (bytes <= 0) {
+        throw std::runtime_error("Cannot read the text");
+      }
+      from += bytes;
+      buffer += bytes;
+    }
+  }
+
+ private:
+  int fd_ = -1;
+  size_t size_ = 0;
+};
+}  // namespace lce_test
+
+/******************************************************************************/
@@ -124,7 +124,7 @@ public:
 
 	}
 
-	uint64_t bit_size(){
+	uint64_t bit_size() const {
 
 		return 8*sizeof(this) + ones.size()*sizeof(uint64_t)*8;
 
@@ -213,7 +213,7 @@ public:
 		return n;
 	}
 
-	uint64_t bit_size(){
+	uint64_t bit_size() const {
 
 		return 8*sizeof(this) + blocks.size()*sizeof(uint128)*8;
 
@@ -143,7 +143,7 @@ public:
     P = packed_vector_127(P_vec);
   }
 
-  inline uint64_t bit_size() {
+  inline uint64_t bit_size() const {
 
     return P.bit_size() + Q1.bit_size() + sizeof(this) * 8;
   }
@@ -0,0 +1,129 @@
+/*******************************************************************************
+ * util/query_file.hpp
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "serialization.hpp"
+
+namespace lce_test {
+
+/* A binary file of LCE queries, written by genqueries. Query k of length
+ * class x is the pair of the positions 2k and 2k + 1 of the class. Its LCE
+ * is in [2^(x-1), 2^x) (0 for x = 0, at least 2^19 for the last class).
+ * Positions take width bytes (5 for texts shorter than 2^40, else 8). The
+ * file starts with the length and a hash of the text, so that queries of
+ * another text are noticed. Opening the file maps it; the positions are not
+ * copied. */
+class query_file {
+ public:
+  static constexpr size_t kNumClasses = 21;
+
+  /* Returns the number of bytes that are needed for the positions of a
+     text of length n. */
+  static uint32_t width_for(uint64_t const n) {
+    return (n < (uint64_t{1} << 40)) ? 5 : 8;
+  }
+
+  /* A fast hash of the text that is good enough to tell texts apart. */
+  static uint64_t hash_text(std::span<uint8_t const> const text) {
+    constexpr uint64_t kMul = 0x9e3779b97f4a7c15ULL;
+    uint64_t h = text.size() * kMul;
+    size_t i = 0;
+    for (; i + 8 <= text.size(); i += 8) {
+      uint64_t word;
+      std::memcpy(&word, text.data() + i, 8);
+      h = std::rotl((h ^ word) * kMul, 29);
+    }
+    uint64_t word = 0;
+    std::memcpy(&word, text.data() + i, text.size() - i);
+    return std::rotl((h ^ word) * kMul, 29) ^ (h >> 31);
+  }
+
+  static void write(std::string const& path, uint64_t const text_size, uint64_t const text_hash,
+                    std::array<std::vector<uint64_t>, kNumClasses> const& positions) {
+    uint32_t const width = width_for(text_size);
+    serialization::writer out(path, kType);
+    out.write(text_size);
+    out.write(text_hash);
+    out.write(width);
+    std::vector<uint8_t> packed;
+    for (auto const& class_positions : positions) {
+      packed.resize(class_positions.size() * width);
+      for (size_t k = 0; k < class_positions.size(); ++k) {
+        static_assert(std::endian::native == std::endian::little);
+        std::memcpy(packed.data() + k * width, &class_positions[k], width);
+      }
+      out.write_array(packed);
+    }
+  }
+
+  explicit query_file(std::string const& path,
+                      serialization::map_options const& opt = serialization::map_options()) {
+    serialization::reader in(path, kType, opt);
+    text_size_ = in.read<uint64_t>();
+    text_hash_ = in.read<uint64_t>();
+    width_ = in.read<uint32_t>();
+    if (width_ < 1 || width_ > 8) {
+      throw std::runtime_error(path + " has an unsupported width");
+    }
+    for (auto& positions : packed_) {
+      positions = in.read_array<uint8_t>();
+    }
+    file_ = in.file();
+  }
+
+  uint64_t text_size() const {
+    return text_size_;
+  }
+
+  uint64_t text_hash() const {
+    return text_hash_;
+  }
+
+  /* Number of positions of a class, i.e., twice the number of queries. */
+  size_t num_positions(size_t const x) const {
+    return packed_[x].size() / width_;
+  }
+
+  uint64_t position(size_t const x, size_t const k) const {
+    uint64_t value = 0;
+    std::memcpy(&value, packed_[x].data() + k * width_, width_);
+    return value;
+  }
+
+  /* Unpacks the first max_positions positions of a class. */
+  std::vector<uint64_t> positions(size_t const x,
+                                  size_t const max_positions = std::numeric_limits<size_t>::max()) const {
+    std::vector<uint64_t> result(std::min(num_positions(x), max_positions));
+    for (size_t k = 0; k < result.size(); ++k) {
+      result[k] = position(x, k);
+    }
+    return result;
+  }
+
+ private:
+  static constexpr char const* kType = "lce_queries";
+
+  std::shared_ptr<serialization::mapped_file> file_;
+  uint64_t text_size_ = 0;
+  uint64_t text_hash_ = 0;
+  uint32_t width_ = 0;
+  std::array<serialization::array<uint8_t>, kNumClasses> packed_;
+};
+}  // namespace lce_test
+
+/******************************************************************************/
@@ -0,0 +1,221 @@
+/*******************************************************************************
+ * util/query_stats.hpp
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace lce_test {
+
+/* Counts which part of the string synchronizing set LCE data structure
+ * answered each query and the sizes of the buckets that the successor
+ * queries search. The counters are only compiled in with LCE_QUERY_STATS
+ * (CMake option of the same name). Otherwise, count() and count_bucket() are
+ * empty and the queries are not slowed down.
+ *
+ * Every thread counts in a block of its own, so the counters do not share
+ * cache lines. collect() sums the blocks of all threads. */
+class query_stats {
+ public:
+#ifdef LCE_QUERY_STATS
+  static constexpr bool enabled = true;
+#else
+  static constexpr bool enabled = false;
+#endif
+
+  enum path : uint8_t {
+    // i == j
+    equal,
+    // The scan ended in the first 8 characters.
+    scan_8,
+    // The scan of up to 3 * tau characters ended after them.
+    scan_block,
+    // No synchronizing position follows, the scan ran to the end.
+    scan_end,
+    // The distances to the next synchronizing positions differ.
+    distance_mismatch,
+    // At most 1024 lcp values of the reduced text were scanned.
+    lcp_scan,
+    // The rmq data structure over the lcp values of the reduced text
+    rmq,
+    // The hierarchy of synchronizing sets
+    hierarchy,
+    kNumPaths
+  };
+
+  static constexpr std::array<char const*, kNumPaths> kPathNames = {
+      "equal", "scan_8", "scan_block", "scan_end", "distance_mismatch",
+      "lcp_scan", "rmq", "hierarchy"};
+
+  // Bucket sizes 0, 1, [2, 4), [4, 8), ..., [2^62, 2^63), and larger
+  static constexpr size_t kNumBucketClasses = 65;
+
+  struct totals {
+    std::array<uint64_t, kNumPaths> paths{};
+    std::array<uint64_t, kNumBucketClasses> buckets{};
+    uint64_t bucket_sum = 0;
+
+    totals& operator+=(totals const& other) {
+      for (size_t p = 0; p < kNumPaths; ++p) {
+        paths[p] += other.paths[p];
+      }
+      for (size_t c = 0; c < kNumBucketClasses; ++c) {
+        buckets[c] += other.buckets[c];
+      }
+      bucket_sum += other.bucket_sum;
+      return *this;
+    }
+
+    uint64_t num_buckets() const {
+      uint64_t result = 0;
+      for (uint64_t const b : buckets) {
+        result += b;
+      }
+      return result;
+    }
+
+    /* Prints "lce_path_<path>=<count> " for every path, the average bucket
+       size, and the bucket sizes as "<smallest size>:<count>,...". */
+    void print(std::ostream& out) const {
+      for (size_t p = 0; p < kNumPaths; ++p) {
+        out << "lce_path_" << kPathNames[p] << "=" << paths[p] << " ";
+      }
+      uint64_t const n = num_buckets();
+      out << "succ_bucket_avg=" << (n > 0 ? double(bucket_sum) / n : 0) << " "
+          << "succ_buckets=";
+      bool first = true;
+      for (size_t c = 0; c < kNumBucketClasses; ++c) {
+        if (buckets[c] > 0) {
+          out << (first ? "" : ",") << min_bucket_size(c) << ":" << buckets[c];
+          first = false;
+        }
+      }
+      out << (first ? "none " : " ");
+    }
+  };
+
+  static void count(path const p) {
+    if constexpr (enabled) {
+      increment(local().paths[p], 1);
+    }
+  }
+
+  static void count_bucket([[maybe_unused]] uint64_t const size) {
+    if constexpr (enabled) {
+      block& b = local();
+      increment(b.buckets[bucket_class(size)], 1);
+      increment(b.bucket_sum, size);
+    }
+  }
+
+  /* Sums the counters of all threads, including threads that ended. */
+  static totals collect() {
+    registry& r = global();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    totals result = r.retired;
+    for (block const* b : r.blocks) {
+      result += b->get();
+    }
+    return result;
+  }
+
+  /* Sets all counters to zero. Must not run concurrently with queries. */
+  static void reset() {
+    registry& r = global();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.retired = totals();
+    for (block* b : r.blocks) {
+      b->clear();
+    }
+  }
+
+  static size_t bucket_class(uint64_t const size) {
+    return (size == 0) ? 0 : 64 - __builtin_clzll(size);
+  }
+
+  static uint64_t min_bucket_size(size_t const c) {
+    return (c == 0) ? 0 : uint64_t{1} << (c - 1);
+  }
+
+ private:
+  /* The counters of one thread. Only the thread writes them, so a relaxed
+     load and store is enough and no atomic read-modify-write is needed. */
+  struct alignas(64) block {
+    std::array<std::atomic<uint64_t>, kNumPaths> paths{};
+    std::array<std::atomic<uint64_t>, kNumBucketClasses> buckets{};
+    std::atomic<uint64_t> bucket_sum{0};
+
+    totals get() const {
+      totals result;
+      for (size_t p = 0; p < kNumPaths; ++p) {
+        result.paths[p] = paths[p].load(std::memory_order_relaxed);
+      }
+      for (size_t c = 0; c < kNumBucketClasses; ++c) {
+        result.buckets[c] = buckets[c].load(std::memory_order_relaxed);
+      }
+      result.bucket_sum = bucket_sum.load(std::memory_order_relaxed);
+      return result;
+    }
+
+    void clear() {
+      for (auto& p : paths) {
+        p.store(0, std::memory_order_relaxed);
+      }
+      for (auto& c : buckets) {
+        c.store(0, std::memory_order_relaxed);
+      }
+      bucket_sum.store(0, std::memory_order_relaxed);
+    }
+  };
+
+  struct registry {
+    std::mutex mutex;
+    std::vector<block*> blocks;
+    // The counts of threads that ended
+    totals retired;
+  };
+
+  /* Registers the block of a thread and keeps its counts when the thread
+     ends. */
+  struct thread_block {
+    block counters;
+
+    thread_block() {
+      registry& r = global();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      r.blocks.push_back(&counters);
+    }
+
+    ~thread_block() {
+      registry& r = global();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      r.retired += counters.get();
+      std::erase(r.blocks, &counters);
+    }
+  };
+
+  static registry& global() {
+    static registry r;
+    return r;
+  }
+
+  static block& local() {
+    thread_local thread_block b;
+    return b.counters;
+  }
+
+  static void increment(std::atomic<uint64_t>& counter, uint64_t const value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+  }
+};
+}  // namespace lce_test
+
+/******************************************************************************/
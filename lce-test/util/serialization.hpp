@@ -0,0 +1,326 @@
+/*******************************************************************************
+ * util/serialization.hpp
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/* Storing LCE data structures in files that can be memory mapped and queried
+ * without copying. A file starts with a header (magic number, format version,
+ * byte order and the type of the data structure) followed by values and
+ * arrays. Every array is aligned to kAlignment bytes in the file, so a mapped
+ * array can be used directly. */
+namespace lce_test::serialization {
+
+static constexpr uint64_t kMagic = 0x5844492d4543414cULL;  // "LACE-IDX"
+static constexpr uint32_t kVersion = 1;
+static constexpr uint32_t kByteOrder = 0x01020304;
+static constexpr size_t kAlignment = 64;
+
+/* Hints for mapping a file. populate reads the whole file during mapping
+ * (MAP_POPULATE), random disables readahead for random queries on files
+ * larger than the memory (MADV_RANDOM), sequential reads ahead aggressively
+ * and drops the pages soon after their use for files that are read once
+ * from the front to the back (MADV_SEQUENTIAL), will_need starts reading
+ * the file in the background (MADV_WILLNEED) and huge_pages asks for
+ * transparent huge pages (MADV_HUGEPAGE). Without random and sequential,
+ * the kernel default applies, which suits indexes that stay in memory. */
+struct map_options {
+  bool populate = false;
+  bool random = false;
+  bool sequential = false;
+  bool will_need = false;
+  bool huge_pages = false;
+};
+
+/* A read-only memory mapped file. */
+class mapped_file {
+ public:
+  mapped_file(std::string const& path, map_options const& opt = map_options()) {
+    int const fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("Cannot open " + path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      throw std::runtime_error("Cannot stat " + path);
+    }
+    size_ = st.st_size;
+    if (size_ > 0) {
+      int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+      if (opt.populate) {
+        flags |= MAP_POPULATE;
+      }
+#endif
+      void* const data = ::mmap(nullptr, size_, PROT_READ, flags, fd, 0);
+      if (data == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("Cannot map " + path);
+      }
+      data_ = static_cast<uint8_t const*>(data);
+      if (opt.random) {
+        ::madvise(data, size_, MADV_RANDOM);
+      } else if (opt.sequential) {
+        ::madvise(data, size_, MADV_SEQUENTIAL);
+      }
+      if (opt.will_need) {
+        ::madvise(data, size_, MADV_WILLNEED);
+      }
+#ifdef MADV_HUGEPAGE
+      if (opt.huge_pages) {
+        ::madvise(data, size_, MADV_HUGEPAGE);
+      }
+#endif
+    }
+    ::close(fd);
+  }
+
+  mapped_file(mapped_file const&) = delete;
+  mapped_file& operator=(mapped_file const&) = delete;
+
+  ~mapped_file() {
+    if (data_ != nullptr) {
+      ::munmap(const_cast<uint8_t*>(data_), size_);
+    }
+  }
+
+  uint8_t const* data() const {
+    return data_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  /* Reads the bytes [from, to) into memory now, e.g., the parts of a file
+     that must not cause I/O later. */
+  void load(size_t const from, size_t const to) const {
+    size_t const page_size = ::sysconf(_SC_PAGESIZE);
+    size_t const begin = from - from % page_size;
+    if (begin >= to) {
+      return;
+    }
+    ::madvise(const_cast<uint8_t*>(data_ + begin), to - begin, MADV_WILLNEED);
+    for (size_t i = begin; i < to; i += page_size) {
+      static_cast<void>(*static_cast<uint8_t const volatile*>(data_ + i));
+    }
+  }
+
+ private:
+  uint8_t const* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+/* A read-only array that either owns its elements or points into a mapped
+ * file. The owner of the mapping has to outlive the array. */
+template <typename T>
+class array {
+  static_assert(std::is_trivially_copyable_v<T>);
+
+ public:
+  array() = default;
+
+  explicit array(std::vector<T>&& elements)
+      : owned_(std::move(elements)), data_(owned_.data()), size_(owned_.size()) {}
+
+  static array view(T const* const data, size_t const size) {
+    array result;
+    result.data_ = data;
+    result.size_ = size;
+    result.is_view_ = true;
+    return result;
+  }
+
+  array(array const& other) {
+    *this = other;
+  }
+
+  // Moving a vector keeps its buffer, so data_ stays valid.
+  array(array&& other) = default;
+  array& operator=(array&& other) = default;
+
+  array& operator=(array const& other) {
+    owned_ = other.owned_;
+    is_view_ = other.is_view_;
+    data_ = is_view_ ? other.data_ : owned_.data();
+    size_ = other.size_;
+    return *this;
+  }
+
+  T const& operator[](size_t const i) const {
+    return data_[i];
+  }
+
+  T const* data() const {
+    return data_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  T const* begin() const {
+    return data_;
+  }
+
+  T const* end() const {
+    return data_ + size_;
+  }
+
+  T const& back() const {
+    return data_[size_ - 1];
+  }
+
+ private:
+  std::vector<T> owned_;
+  T const* data_ = nullptr;
+  size_t size_ = 0;
+  bool is_view_ = false;
+};
+
+/* Writes a data structure to a file. */
+class writer {
+ public:
+  /* Writes the header. type identifies the data structure, including all
+     template parameters that change the layout. */
+  writer(std::string const& path, std::string const& type)
+      : out_(path, std::ios::out | std::ios::binary | std::ios::trunc) {
+    if (!out_) {
+      throw std::runtime_error("Cannot write " + path);
+    }
+    write(kMagic);
+    write(kVersion);
+    write(kByteOrder);
+    write_string(type);
+  }
+
+  template <typename T>
+  void write(T const& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    out_.write(reinterpret_cast<char const*>(&value), sizeof(T));
+    pos_ += sizeof(T);
+  }
+
+  void write_string(std::string const& str) {
+    write_array(str.data(), str.size());
+  }
+
+  /* Writes the size and then, aligned to kAlignment, the elements. */
+  template <typename T>
+  void write_array(T const* const data, size_t const size) {
+    begin_array(size);
+    write_elements(data, size);
+  }
+
+  /* Writes the size and the alignment of an array, whose size elements must
+     follow with write_elements(), e.g., in parts that fit into memory. */
+  void begin_array(size_t const size) {
+    write(uint64_t{size});
+    size_t const padding = (kAlignment - pos_ % kAlignment) % kAlignment;
+    char const zeros[kAlignment] = {};
+    out_.write(zeros, padding);
+    pos_ += padding;
+  }
+
+  template <typename T>
+  void write_elements(T const* const data, size_t const size) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    out_.write(reinterpret_cast<char const*>(data), size * sizeof(T));
+    pos_ += size * sizeof(T);
+    if (!out_) {
+      throw std::runtime_error("Cannot write index");
+    }
+  }
+
+  template <typename Array>
+  void write_array(Array const& elements) {
+    write_array(elements.data(), elements.size());
+  }
+
+ private:
+  std::ofstream out_;
+  size_t pos_ = 0;
+};
+
+/* Reads a data structure from a mapped file. Arrays are not copied. */
+class reader {
+ public:
+  /* Maps the file and checks the header. */
+  reader(std::string const& path, std::string const& type, map_options const& opt = map_options())
+      : file_(std::make_shared<mapped_file>(path, opt)) {
+    if (read<uint64_t>() != kMagic) {
+      throw std::runtime_error(path + " is not an LCE index");
+    }
+    if (read<uint32_t>() != kVersion || read<uint32_t>() != kByteOrder) {
+      throw std::runtime_error(path + " has an unsupported version or byte order");
+    }
+    std::string const stored_type = read_string();
+    if (stored_type != type) {
+      throw std::runtime_error(path + " contains " + stored_type + ", not " + type);
+    }
+  }
+
+  template <typename T>
+  T read() {
+    static_assert(std::is_trivially_copyable_v<T>);
+    check(sizeof(T));
+    T value;
+    std::memcpy(&value, file_->data() + pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return value;
+  }
+
+  std::string read_string() {
+    array<char> const str = read_array<char>();
+    return std::string(str.begin(), str.end());
+  }
+
+  template <typename T>
+  array<T> read_array() {
+    size_t const size = read<uint64_t>();
+    pos_ += (kAlignment - pos_ % kAlignment) % kAlignment;
+    check(size * sizeof(T));
+    T const* const data = reinterpret_cast<T const*>(file_->data() + pos_);
+    pos_ += size * sizeof(T);
+    return array<T>::view(data, size);
+  }
+
+  /* The mapping, which has to be kept alive as long as the arrays are used. */
+  std::shared_ptr<mapped_file> const& file() const {
+    return file_;
+  }
+
+ private:
+  std::shared_ptr<mapped_file> file_;
+  size_t pos_ = 0;
+
+  void check(size_t const bytes) const {
+    if (pos_ + bytes > file_->size()) {
+      throw std::runtime_error("LCE index is truncated");
+    }
+  }
+};
+}  // namespace lce_test::serialization
+
+/******************************************************************************/
@@ -13,6 +13,16 @@ private:
     size_t m_width;
     size_t m_mask;
     std::vector<uint64_t> m_data;
+    const uint64_t* m_view = nullptr; // words in a mapped file, if not null
+
+    inline const uint64_t* words() const {
+        return m_view ? m_view : m_data.data();
+    }
+
+    static inline size_t num_words(size_t size, size_t width) {
+        const size_t bits = size * width;
+        return (bits >> 6ULL) + ((bits & 63ULL) ? 1 : 0);
+    }
 
     inline void set(size_t i, uint64_t v) {
         v &= m_mask; // make sure it fits...
@@ -59,12 +69,12 @@ private:
         const size_t wa = 64ULL - da;
 
         // get the wa highest bits from a
-        const uint64_t a_hi = m_data[a] >> da;
+        const uint64_t a_hi = words()[a] >> da;
 
         // get b (its high bits will be masked away below)
         // NOTE: we could save this step if we knew a == b,
         //       but the branch caused by checking that is too expensive
-        const uint64_t b_lo = m_data[b];
+        const uint64_t b_lo = words()[b];
 
         // combine
         return ((b_lo << wa) | a_hi) & m_mask;
@@ -104,6 +114,7 @@ public:
         m_width = other.m_width;
         m_mask = other.m_mask;
         m_data = other.m_data;
+        m_view = other.m_view;
         return *this;
     }
 
@@ -112,6 +123,7 @@ public:
         m_width = other.m_width;
         m_mask = other.m_mask;
         m_data = std::move(other.m_data);
+        m_view = other.m_view;
         return *this;
     }
 
@@ -120,10 +132,27 @@ public:
         m_width = width;
         m_mask = bit_mask(width);
         
-        const size_t bits = m_size * m_width;
-        const size_t q = bits >> 6ULL; // divide by 64
-        const size_t k = bits & 63ULL; // mod 64
-        m_data.resize(k ? q + 1 : q);
+        m_data.resize(num_words(m_size, m_width));
+        m_view = nullptr;
+    }
+
+    // writes the vector with a lce_test::serialization::writer
+    template<typename writer_t>
+    inline void save(writer_t& out) const {
+        out.write(uint64_t(m_size));
+        out.write(uint64_t(m_width));
+        out.write_array(words(), num_words(m_size, m_width));
+    }
+
+    // reads the vector with a lce_test::serialization::reader, the words
+    // are not copied
+    template<typename reader_t>
+    inline void load(reader_t& in) {
+        m_size = in.template read<uint64_t>();
+        m_width = in.template read<uint64_t>();
+        m_mask = bit_mask(m_width);
+        m_data.clear();
+        m_view = in.template read_array<uint64_t>().data();
     }
 
     inline void rebuild(size_t size, size_t width) {
@@ -136,6 +165,7 @@ public:
         m_width = new_iv.m_width;
         m_mask = new_iv.m_mask;
         m_data = std::move(new_iv.m_data);
+        m_view = nullptr;
     }
 
     inline void rebuild(size_t size) {
@@ -153,6 +183,11 @@ public:
     inline size_t size() const {
         return m_size;
     }
+
+    // size of the packed words in bytes
+    inline size_t size_in_bytes() const {
+        return num_words(m_size, m_width) * sizeof(uint64_t);
+    }
 };
 
 }
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 
+#include "../query_stats.hpp"
 #include "helpers/util.hpp"
 #include "helpers/int_vector.hpp"
 
@@ -64,6 +65,11 @@ public:
         m_hi_idx[m_key_max - m_key_min + 1] = m_num;
     }
 
+    // size of the index (but not the array) in bytes
+    inline size_t size_in_bytes() const {
+        return m_hi_idx.size_in_bytes();
+    }
+
     // finds the greatest element less than OR equal to x
     inline result predecessor(const item_t x) const {
         if(unlikely(x < m_min))  return result { false, 0 };
@@ -72,6 +78,7 @@ public:
         const uint64_t key = hi(x) - m_key_min;
         const size_t p = m_hi_idx[key];
         const size_t q = m_hi_idx[key+1];
+        lce_test::query_stats::count_bucket(q - p);
         return {true, static_cast<size_t>(std::distance(m_array->data(), std::upper_bound(m_array->data() + p,  m_array->data() + q, x)) - 1)};
     }
 
@@ -83,6 +90,7 @@ public:
         const uint64_t key = hi(x) - m_key_min;
         const size_t p = m_hi_idx[key];
         const size_t q = m_hi_idx[key+1];
+        lce_test::query_stats::count_bucket(q - p);
         return {true, static_cast<size_t>(std::distance(m_array->data(), std::lower_bound(m_array->data() + p,  m_array->data() + q, x)))}; 
     }
 };
@@ -1,8 +1,10 @@
 #pragma once
 
-#include <omp.h>
 #include <algorithm>
 
+#include "../execution.hpp"
+#include "../query_stats.hpp"
+#include "../timeline.hpp"
 #include "helpers/util.hpp"
 #include "helpers/int_vector.hpp"
 
@@ -36,7 +38,8 @@ private:
     int_vector m_hi_idx;
 
 public:
-    inline index_par(const array_t& array)
+    template<typename Exec = lce_test::execution::default_policy>
+    inline index_par(const array_t& array, const Exec& exec = Exec())
         : m_array(&array),
           m_num(array.size()),
           m_min(array[0]),
@@ -45,21 +48,18 @@ public:
         assert_sorted_ascending(array);
 
         // build an index for high bits
+        lce_test::timeline::span const span("index_par");
         m_key_min = uint64_t(m_min) >> m_lo_bits;
         m_key_max = uint64_t(m_max) >> m_lo_bits;
         m_hi_idx = int_vector(m_key_max - m_key_min + 2, log2_ceil(m_num));
-        #pragma omp parallel
-        {
-            const int t = omp_get_thread_num();
-            const int nt = omp_get_num_threads();
-            const size_t size_per_thread = m_num / nt;
-            const size_t start_i = t * size_per_thread;
-            const size_t end_i = (t == nt - 1) ? m_num : (t + 1) * size_per_thread;
-
-            if(t == 0) {
-                m_hi_idx[0] = 0;
+        m_hi_idx[0] = 0;
+        exec.for_each_block([&](const int t, const int nt) {
+            const auto [start_i, end_i] = lce_test::execution::block_range(m_num, t, nt);
+            if(start_i == end_i) {
+                return;
             }
-            uint64_t prev_key = (t == 0) ? m_key_min : hi(array[start_i-1]);
+
+            uint64_t prev_key = (start_i == 0) ? m_key_min : hi(array[start_i-1]);
             for(size_t i = start_i; i < end_i; ++i) {
                 const uint64_t cur_key = hi(array[i]);
                 if(cur_key > prev_key) {
@@ -69,10 +69,38 @@ public:
                 }
                 prev_key = cur_key;
             }
-        }
+        });
         m_hi_idx[m_key_max - m_key_min + 1] = m_num;
     }
 
+    // reads the index for array with a lce_test::serialization::reader
+    template<typename reader_t>
+    inline index_par(reader_t& in, const array_t& array)
+        : m_array(&array),
+          m_num(in.template read<uint64_t>()),
+          m_min(in.template read<item_t>()),
+          m_max(in.template read<item_t>()),
+          m_key_min(in.template read<uint64_t>()),
+          m_key_max(in.template read<uint64_t>()) {
+        m_hi_idx.load(in);
+    }
+
+    // writes the index (but not the array) with a lce_test::serialization::writer
+    template<typename writer_t>
+    inline void save(writer_t& out) const {
+        out.write(uint64_t(m_num));
+        out.write(m_min);
+        out.write(m_max);
+        out.write(m_key_min);
+        out.write(m_key_max);
+        m_hi_idx.save(out);
+    }
+
+    // size of the index (but not the array) in bytes
+    inline size_t size_in_bytes() const {
+        return m_hi_idx.size_in_bytes();
+    }
+
     // finds the greatest element less than OR equal to x
     inline result predecessor(const item_t x) const {
         if(unlikely(x < m_min))  return result { false, 0 };
@@ -81,6 +109,7 @@ public:
         const uint64_t key = hi(x) - m_key_min;
         const size_t p = m_hi_idx[key];
         const size_t q = m_hi_idx[key+1];
+        lce_test::query_stats::count_bucket(q - p);
         return {true, static_cast<size_t>(std::distance(m_array->data(), std::upper_bound(m_array->data() + p,  m_array->data() + q, x)) - 1)};
     }
 
@@ -92,6 +121,7 @@ public:
         const uint64_t key = hi(x) - m_key_min;
         const size_t p = m_hi_idx[key];
         const size_t q = m_hi_idx[key+1];
+        lce_test::query_stats::count_bucket(q - p);
         return {true, static_cast<size_t>(std::distance(m_array->data(), std::lower_bound(m_array->data() + p,  m_array->data() + q, x)))}; 
     }
 };
@@ -0,0 +1,218 @@
+/*******************************************************************************
+ * util/timeline.hpp
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace lce_test {
+
+/* Records the spans of time that each thread spends in a part of the
+ * construction, to see idle threads and serial gaps between the parallel
+ * regions. A span is recorded by a span object until its destruction or
+ * stop(). The phases of phase_profiler are spans, and the execution policies
+ * record a span for every block that a thread works on, named after the
+ * innermost span of the thread that started the parallel region.
+ *
+ * Recording is off until enable() is called. Every thread appends to a
+ * buffer of its own. write_chrome_json() writes the spans in the Trace Event
+ * Format of Chrome (chrome://tracing) and Perfetto (ui.perfetto.dev). It must
+ * not run concurrently with spans. */
+class timeline {
+ public:
+  struct event {
+    char const* name;
+    uint32_t thread;
+    // -1 if the span is not a block of a parallel region
+    int32_t block;
+    uint64_t begin_ns;
+    uint64_t end_ns;
+  };
+
+  /* The timeline that the spans record to */
+  static timeline& global() {
+    static timeline t;
+    return t;
+  }
+
+  /* Starts recording. Times are relative to the first call. Threads are
+     numbered in the order of their first span. */
+  void enable() {
+    if (!started_) {
+      origin_ = std::chrono::steady_clock::now();
+      started_ = true;
+    }
+    enabled_.store(true, std::memory_order_relaxed);
+  }
+
+  void disable() {
+    enabled_.store(false, std::memory_order_relaxed);
+  }
+
+  bool enabled() const {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  class span {
+   public:
+    explicit span(char const* const name, int32_t const block = -1)
+        : events_(global().enabled() ? &global().local() : nullptr), name_(name),
+          block_(block), outer_(current_name()) {
+      if (events_ != nullptr) {
+        current_name() = name;
+        begin_ns_ = global().now_ns();
+      }
+    }
+
+    span(span const&) = delete;
+    span& operator=(span const&) = delete;
+
+    ~span() {
+      stop();
+    }
+
+    /* Ends the span before the end of the scope. */
+    void stop() {
+      if (events_ == nullptr) {
+        return;
+      }
+      events_->push_back(event{name_, 0, block_, begin_ns_, global().now_ns()});
+      current_name() = outer_;
+      events_ = nullptr;
+    }
+
+   private:
+    // The buffer of the thread, if the timeline is enabled
+    std::vector<event>* events_;
+    char const* const name_;
+    int32_t const block_;
+    char const* const outer_;
+    uint64_t begin_ns_ = 0;
+  };
+
+  /* The innermost span of the calling thread, or nullptr */
+  static char const* current() {
+    return current_name();
+  }
+
+  /* The spans of all threads, ordered by their begin */
+  std::vector<event> events() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<event> result = retired_;
+    for (buffer const* b : buffers_) {
+      for (event e : b->events) {
+        e.thread = b->thread;
+        result.push_back(e);
+      }
+    }
+    std::sort(result.begin(), result.end(), [](event const& a, event const& b) {
+      return a.begin_ns < b.begin_ns;
+    });
+    return result;
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    retired_.clear();
+    for (buffer* b : buffers_) {
+      b->events.clear();
+    }
+  }
+
+  /* Writes the spans as complete ("X") events. Times are in microseconds. */
+  void write_chrome_json(std::ostream& out) const {
+    std::vector<event> const all = events();
+    uint32_t num_threads = 0;
+    for (event const& e : all) {
+      num_threads = std::max(num_threads, e.thread + 1);
+    }
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    for (uint32_t t = 0; t < num_threads; ++t) {
+      out << (t == 0 ? "" : ",") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t
+          << ",\"args\":{\"name\":\"thread " << t << "\"}}";
+    }
+    for (event const& e : all) {
+      out << (num_threads == 0 ? "" : ",") << "{\"name\":\"" << e.name
+          << "\",\"cat\":\"" << (e.block < 0 ? "phase" : "block")
+          << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.thread
+          << ",\"ts\":" << microseconds(e.begin_ns) << ",\"dur\":" << microseconds(e.end_ns - e.begin_ns);
+      if (e.block >= 0) {
+        out << ",\"args\":{\"block\":" << e.block << "}";
+      }
+      out << "}";
+    }
+    out << "]}";
+  }
+
+ private:
+  struct buffer {
+    uint32_t thread;
+    std::vector<event> events;
+  };
+
+  /* Registers the buffer of a thread and keeps its spans when the thread
+     ends. */
+  struct thread_buffer {
+    timeline& owner;
+    buffer b;
+
+    explicit thread_buffer(timeline& t) : owner(t) {
+      std::lock_guard<std::mutex> lock(owner.mutex_);
+      b.thread = owner.num_threads_++;
+      owner.buffers_.push_back(&b);
+    }
+
+    ~thread_buffer() {
+      std::lock_guard<std::mutex> lock(owner.mutex_);
+      for (event e : b.events) {
+        e.thread = b.thread;
+        owner.retired_.push_back(e);
+      }
+      std::erase(owner.buffers_, &b);
+    }
+  };
+
+  std::atomic<bool> enabled_ = false;
+  bool started_ = false;
+  std::chrono::steady_clock::time_point origin_;
+
+  mutable std::mutex mutex_;
+  uint32_t num_threads_ = 0;
+  std::vector<buffer*> buffers_;
+  // The spans of threads that ended
+  std::vector<event> retired_;
+
+  // Exact, unlike a double in the default precision of streams
+  static std::string microseconds(uint64_t const ns) {
+    std::string const fraction = std::to_string(1000 + ns % 1000).substr(1);
+    return std::to_string(ns / 1000) + "." + fraction;
+  }
+
+  uint64_t now_ns() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - origin_).count();
+  }
+
+  std::vector<event>& local() {
+    thread_local thread_buffer b(*this);
+    return b.b.events;
+  }
+
+  static char const*& current_name() {
+    thread_local char const* name = nullptr;
+    return name;
+  }
+};
+}  // namespace lce_test
+
+/******************************************************************************/
@@ -0,0 +1,255 @@
+/*******************************************************************************
+ * util/trace_recorder.hpp
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lce_interface.hpp"
+#include "serialization.hpp"
+
+namespace lce_test {
+
+/* A query of a trace. time_ns is the time of the call since the recorder
+ * was created. thread numbers the threads in the order of their first
+ * query. */
+struct trace_record {
+  static constexpr uint8_t kBatchStart = 1;  // First query of a batch
+  static constexpr uint8_t kCompare = 2;     // isSmallerSuffix instead of lce
+
+  uint64_t time_ns;
+  uint64_t i;
+  uint64_t j;
+  uint32_t result;  // The LCE (capped at 2^32 - 1) or the comparison
+  uint16_t thread;
+  uint8_t flags;
+  uint8_t reserved;
+};
+static_assert(sizeof(trace_record) == 32);
+
+struct trace_header {
+  static constexpr uint64_t kMagic = 0x45434152544543ULL;  // "CETRACE"
+  static constexpr uint32_t kVersion = 1;
+
+  uint64_t magic = kMagic;
+  uint32_t version = kVersion;
+  uint32_t record_size = sizeof(trace_record);
+  uint64_t text_size = 0;
+};
+
+/* Wraps an LCE data structure and writes all its queries to a trace, which
+ * bench_replay can replay. Every thread collects its records in a buffer of
+ * its own, so recording only costs a clock read per query. Full buffers are
+ * appended to the file, hence the records of different threads are not
+ * ordered by time. All threads must be done before the recorder is
+ * destroyed. */
+class trace_recorder : public LceDataStructure {
+ public:
+  static constexpr size_t kMaxThreads = 1024;
+  static constexpr size_t kBufferRecords = size_t{1} << 16;
+
+  trace_recorder(std::unique_ptr<LceDataStructure> lce, std::string const& path)
+      : trace_recorder(*lce, path) {
+    owned_ = std::move(lce);
+  }
+
+  trace_recorder(LceDataStructure& lce, std::string const& path)
+      : lce_(&lce), out_(path, std::ios::out | std::ios::binary | std::ios::trunc),
+        start_(std::chrono::steady_clock::now()) {
+    if (!out_) {
+      throw std::runtime_error("Cannot write " + path);
+    }
+    trace_header header;
+    header.text_size = lce_->getSizeInBytes();
+    out_.write(reinterpret_cast<char const*>(&header), sizeof(header));
+  }
+
+  ~trace_recorder() {
+    for (auto& buffer : buffers_) {
+      if (buffer) {
+        flush(*buffer);
+      }
+    }
+  }
+
+  /* The wrapped data structure, whose queries are not recorded */
+  LceDataStructure& recorded() const {
+    return *lce_;
+  }
+
+  /* The next query of the calling thread starts a batch. */
+  void begin_batch() {
+    local().flags = trace_record::kBatchStart;
+  }
+
+  uint64_t lce(uint64_t const i, uint64_t const j) override {
+    uint64_t const time = now();
+    uint64_t const result = lce_->lce(i, j);
+    record(time, i, j, std::min<uint64_t>(result, std::numeric_limits<uint32_t>::max()), 0);
+    return result;
+  }
+
+  int isSmallerSuffix(uint64_t const i, uint64_t const j) override {
+    uint64_t const time = now();
+    int const result = lce_->isSmallerSuffix(i, j);
+    record(time, i, j, result, trace_record::kCompare);
+    return result;
+  }
+
+  char operator[](uint64_t const i) override {
+    return (*lce_)[i];
+  }
+
+  uint64_t getSizeInBytes() override {
+    return lce_->getSizeInBytes();
+  }
+
+  std::vector<space_component> space_breakdown() const override {
+    return lce_->space_breakdown();
+  }
+
+  void save(std::string const& path) const override {
+    lce_->save(path);
+  }
+
+ private:
+  struct buffer {
+    std::thread::id owner;
+    uint16_t thread = 0;
+    uint8_t flags = 0;
+    std::vector<trace_record> records;
+  };
+
+  std::unique_ptr<LceDataStructure> owned_;
+  LceDataStructure* const lce_;
+  std::ofstream out_;
+  std::mutex out_mutex_;
+  std::chrono::steady_clock::time_point const start_;
+  uint64_t const id_ = next_id();
+  std::mutex buffers_mutex_;
+  size_t num_threads_ = 0;
+  std::array<std::unique_ptr<buffer>, kMaxThreads> buffers_;
+
+  static uint64_t next_id() {
+    static std::atomic<uint64_t> id = 0;
+    return ++id;
+  }
+
+  uint64_t now() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start_).count();
+  }
+
+  /* The buffer of the calling thread. Only the recorder that the thread
+     used last is cached, since a thread may alternate between recorders. */
+  buffer& local() {
+    thread_local uint64_t cached_id = 0;
+    thread_local buffer* cached = nullptr;
+    if (cached_id != id_) {
+      cached = &find_buffer();
+      cached_id = id_;
+    }
+    return *cached;
+  }
+
+  /* Returns the buffer of the calling thread in this recorder or, on its
+     first query, a new one. */
+  buffer& find_buffer() {
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    std::thread::id const self = std::this_thread::get_id();
+    for (size_t thread = 0; thread < num_threads_; ++thread) {
+      if (buffers_[thread]->owner == self) {
+        return *buffers_[thread];
+      }
+    }
+    if (num_threads_ == kMaxThreads) {
+      throw std::runtime_error("Too many threads for the trace recorder");
+    }
+    size_t const thread = num_threads_++;
+    buffers_[thread] = std::make_unique<buffer>();
+    buffers_[thread]->owner = self;
+    buffers_[thread]->thread = thread;
+    buffers_[thread]->records.reserve(kBufferRecords);
+    return *buffers_[thread];
+  }
+
+  void record(uint64_t const time, uint64_t const i, uint64_t const j, uint32_t const result,
+              uint8_t const flags) {
+    buffer& b = local();
+    b.records.push_back(trace_record{time, i, j, result, b.thread, uint8_t(flags | b.flags), 0});
+    b.flags = 0;
+    if (b.records.size() == kBufferRecords) {
+      flush(b);
+    }
+  }
+
+  void flush(buffer& b) {
+    std::lock_guard<std::mutex> lock(out_mutex_);
+    out_.write(reinterpret_cast<char const*>(b.records.data()), b.records.size() * sizeof(trace_record));
+    b.records.clear();
+  }
+};
+
+/* A trace written by trace_recorder, mapped into memory. */
+class trace_file {
+ public:
+  explicit trace_file(std::string const& path)
+      : file_(path, sequential()) {
+    trace_header header;
+    if (file_.size() < sizeof(header)) {
+      throw std::runtime_error(path + " is not an LCE trace");
+    }
+    std::memcpy(&header, file_.data(), sizeof(header));
+    if (header.magic != trace_header::kMagic || header.version != trace_header::kVersion ||
+        header.record_size != sizeof(trace_record)) {
+      throw std::runtime_error(path + " is not an LCE trace of this version");
+    }
+    text_size_ = header.text_size;
+    // A trace of a recorder that crashed may end with a partial record.
+    size_t const num_records = (file_.size() - sizeof(header)) / sizeof(trace_record);
+    records_ = std::span<trace_record const>(
+        reinterpret_cast<trace_record const*>(file_.data() + sizeof(header)), num_records);
+  }
+
+  uint64_t text_size() const {
+    return text_size_;
+  }
+
+  /* The records in the order in which they were written */
+  std::span<trace_record const> records() const {
+    return records_;
+  }
+
+ private:
+  serialization::mapped_file file_;
+
+  static serialization::map_options sequential() {
+    serialization::map_options opt;
+    opt.sequential = true;
+    opt.will_need = true;
+    return opt;
+  }
+
+  uint64_t text_size_ = 0;
+  std::span<trace_record const> records_;
+};
+}  // namespace lce_test
+
+/******************************************************************************/
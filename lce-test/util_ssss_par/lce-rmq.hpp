@@ -19,47 +19,41 @@
 #include <ips4o.hpp>
 #include <tlx/sort/strings/parallel_sample_sort.hpp>
 
+#include "../util/execution.hpp"
+#include "../util/lce_interface.hpp"
+#include "../util/phase_profiler.hpp"
+#include "../util/query_stats.hpp"
+#include "../util/serialization.hpp"
 #include "par_rmq_n.hpp"
+#include "reduced_text.hpp"
+#include "sss_hierarchy.hpp"
 #include "string_sort_helper.hpp"
 
-#ifdef DETAILED_TIME
-#include <malloc_count.h>
-#endif
 
 namespace lce_test::par {
 
-template <typename sss_type>
-struct rank_tuple {
-  sss_type index;
-  uint32_t rank; //We assume the string synchronizing set hold less than 2^31 values. For tau=512 this is around 500GB text.
-
-  rank_tuple() = default;
-  rank_tuple(sss_type _index, uint32_t _rank) : index(_index), rank(_rank) {}
-
-  friend std::ostream& operator<<(std::ostream& os, rank_tuple const& rt) {
-    return os << "[ " << rt.index << ", " << rt.rank << "]";
-  }
-};  // struct rank_tuple
-
-template <typename sss_type, uint64_t kTau = 1024>
+/* Answers LCE queries for the positions of a string synchronizing set. The
+ * 3*tau long strings starting at these positions are replaced by their rank.
+ * Then, either a suffix array, LCP array and RMQ data structure of this
+ * reduced text are build or, if t_hierarchical is set, a hierarchy of string
+ * synchronizing sets over it (see sss_hierarchy.hpp). */
+template <typename sss_type, uint64_t kTau = 1024, bool t_hierarchical = false>
 class Lce_rmq_par {
  public:
+  template <typename Exec = execution::default_policy>
   Lce_rmq_par(uint8_t const* const v_text, size_t const v_text_size,
-              string_synchronizing_set_par<kTau, sss_type> const& sync_set)
-      : text(v_text), text_size(v_text_size) {
-#ifdef DETAILED_TIME
-    size_t mem_before = malloc_count_current();
-    malloc_count_reset_peak();
-    std::chrono::system_clock::time_point begin = std::chrono::system_clock::now();
-#endif
-
+              string_synchronizing_set_par<kTau, sss_type> const& sync_set,
+              Exec const& exec = Exec())
+      : text(v_text), text_size(v_text_size),
+        m_sss(sync_set.get_sss().data()), m_sss_size(sync_set.size()) {
+    phase_profiler::scope sort_phase("string_sort");
     // Sort 3*tau long strings starting at string synchronizing set positions in parallel
     std::vector<sss_type> strings_to_sort(sync_set.get_sss().begin(), sync_set.get_sss().end());
     mock_string text_str(v_text, v_text_size);
     StringShortSuffixSet<3 * kTau, sss_type> sufset{text_str, strings_to_sort.begin(), strings_to_sort.end(), sync_set};
 
     tlx::sort_strings_detail::StringPtr strptr(sufset);
-    tlx::sort_strings_detail::parallel_sample_sort(strptr, 0, static_cast<size_t>(omp_get_max_threads()), 0);
+    tlx::sort_strings_detail::parallel_sample_sort(strptr, 0, static_cast<size_t>(exec.num_threads()), 0);
     
     // Check sorted strings
     /*{
@@ -70,68 +64,23 @@ class Lce_rmq_par {
       }
     }*/
 
-#ifdef DETAILED_TIME
-    std::chrono::system_clock::time_point end = std::chrono::system_clock::now();
-    std::cout << "string_sort_time="
-              << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << " "
-              << "string_sort_mem=" << (malloc_count_peak() - mem_before) << " ";
-#endif
-
-#ifdef DETAILED_TIME
-    mem_before = malloc_count_current();
-    malloc_count_reset_peak();
-    begin = std::chrono::system_clock::now();
-#endif
+    sort_phase.stop();
 
+    phase_profiler::scope rank_phase("rank");
     // Reduce alphabet by giving sorted strings their rank.
-    std::vector<rank_tuple<sss_type>> rank_tuples(strings_to_sort.size()); // Store <sss_index, rank> tuples.
-    // We may need to adjust ranks at thread borders.
-    int nt = omp_get_max_threads();
-    std::vector<sss_type> max_ranks(nt);  // Max rank in block
-    std::vector<char> all_ranks_equal(nt); // Are all ranks in the block equal?
-    std::vector<char> rank_extends_prev_block(nt); // Is first rank in block == last rank in prev block?
-
-#pragma omp parallel
-    {
-      // First compare strings in block and adjust ranks
-      const int t = omp_get_thread_num();
-      const int nt = omp_get_num_threads();
-      const size_t size_per_thread = rank_tuples.size() / nt;
-      const size_t start_i = t * size_per_thread;
-      const size_t end_i = (t == nt - 1) ? rank_tuples.size() : (t + 1) * size_per_thread;
-
-      uint32_t cur_rank = start_i + 1;
-      rank_tuples[start_i] = {static_cast<sss_type>(strings_to_sort[start_i]), cur_rank};
-
-      for (size_t i = start_i + 1; i < end_i; ++i) {
-        assert(leq_three_tau(strings_to_sort[i-1], strings_to_sort[i], sync_set));
-        if(!eq_three_tau(strings_to_sort[i-1], strings_to_sort[i], sync_set)) {
-          ++cur_rank;
-        }
-        rank_tuples[i] = {strings_to_sort[i], cur_rank};
-      }
-      max_ranks[t] = cur_rank;
-
-#pragma omp barrier
-      assert (rank_tuples[start_i].rank == start_i+1);
-      all_ranks_equal[t] = (max_ranks[t] == start_i+1);
-      rank_extends_prev_block[t] = (t == 0) ? false : eq_three_tau(strings_to_sort[start_i-1], strings_to_sort[start_i], sync_set);
-#pragma omp barrier
-      // Now adjust ranks between blocks 
-      if(t != 0) {
-        if(rank_extends_prev_block[t]) {
-          size_t target_t = t-1;
-          while(all_ranks_equal[target_t] && rank_extends_prev_block[target_t]) {
-            --target_t;
-          }
-          sss_type target_rank = max_ranks[target_t];
-          
-          const uint32_t rank_to_decrease = rank_tuples[start_i].rank;
-          for (size_t i = start_i; i < end_i && rank_tuples[i].rank == rank_to_decrease; ++i) { 
-            rank_tuples[i].rank = target_rank;
-          }
-        } 
-      }
+    std::vector<rank_tuple<sss_type>> rank_tuples;
+    if constexpr (t_hierarchical) {
+      // Strings with names of their own go to the end.
+      std::stable_partition(strings_to_sort.begin(), strings_to_sort.end(),
+                            [&](sss_type const i) { return !has_unique_name(i); });
+      rank_tuples = compute_ranks(strings_to_sort, [&](sss_type const i, sss_type const j) {
+        return !has_unique_name(i) && !has_unique_name(j) && eq_three_tau(i, j, sync_set);
+      }, exec);
+    } else {
+      rank_tuples = compute_ranks(strings_to_sort, [&](sss_type const i, sss_type const j) {
+        assert(leq_three_tau(i, j, sync_set));
+        return eq_three_tau(i, j, sync_set);
+      }, exec);
     }
     uint32_t max_rank = rank_tuples.back().rank + 1;
     // Check rank_tuples
@@ -147,95 +96,59 @@ class Lce_rmq_par {
       }
     }*/
 
-    ips4o::sort(rank_tuples.begin(), rank_tuples.end(),
-                [](rank_tuple<sss_type> const& lhs, rank_tuple<sss_type> const& rhs) {
-                  return lhs.index < rhs.index;
-                });
+    std::vector<uint32_t> new_text = reduced_text(rank_tuples, exec);
 
-    std::vector<uint32_t> new_text(rank_tuples.size() + 1, 0);
-    std::vector<uint32_t> new_sa(new_text.size(), 0);
-#pragma omp parallel for
-    for (size_t i = 0; i < rank_tuples.size(); ++i) {
-      new_text[i] = rank_tuples[i].rank;
-    }
-    new_text.back() = 0;
-    libsais_int_omp(reinterpret_cast<int32_t*>(new_text.data()), reinterpret_cast<int32_t*>(new_sa.data()), new_text.size(), max_rank + 1, 0, omp_get_max_threads());
-
-#ifdef DETAILED_TIME
-    end = std::chrono::system_clock::now();
-    std::cout << "sa_construct_time="
-              << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << " "
-              << "sa_construct_mem=" << (malloc_count_peak() - mem_before) << " ";
-#endif
-
-#ifdef DETAILED_TIME
-    mem_before = malloc_count_current();
-    malloc_count_reset_peak();
-    begin = std::chrono::system_clock::now();
-#endif
-    isa.resize(new_sa.size());
-#pragma omp parallel for
-    for (uint32_t i = 0; i < new_sa.size(); ++i) {
-      isa[new_sa[i]] = i;
+    rank_phase.stop();
+
+    if constexpr (t_hierarchical) {
+      build_hierarchy(std::move(new_text), exec);
+    } else {
+      build_rmq(new_text, max_rank, exec, [this](uint64_t const i, uint64_t const j) {
+        return lce_in_text(i, j);
+      });
     }
+  }
 
-    lcp.resize(new_sa.size());
-    lcp[0] = 0;
-    lcp[1] = 0;
-    size_t current_lcp = 0;
-#pragma omp parallel for firstprivate (current_lcp)
-    for (size_t i = 0; i < lcp.size()-1; ++i) {
-      size_t suffix_array_pos = isa[i];
-      assert(suffix_array_pos != 0); //We stop loop before before isa[lce.size()-1]==0
-      if (suffix_array_pos == 1) {continue;} //We can not do lce_query with sentinel new_sa.back()
-      size_t preceding_suffix_pos = new_sa[suffix_array_pos - 1];
-      current_lcp += lce_in_text(sync_set[i] + current_lcp, sync_set[preceding_suffix_pos] + current_lcp);
-      lcp[suffix_array_pos] = current_lcp;
-
-      uint64_t diff = sync_set[i + 1] - sync_set[i];
-      if (current_lcp < 2 * kTau + diff) {
-        current_lcp = 0;
-      } else {
-        current_lcp -= diff;
-      }
+  /* Builds the data structure from the reduced text, i.e., the names of the
+     3*tau long strings starting at sss[0, sss_size) followed by a 0
+     sentinel. The names are less than max_rank. This is used by the
+     external memory construction, which names the strings itself and
+     answers the LCEs of the text for the LCP array with text_lce(i, j). The
+     text is not accessed, so only save() may be called. */
+  template <typename TextLce, typename Exec = execution::default_policy>
+  Lce_rmq_par(size_t const v_text_size, sss_type const* const sss, size_t const sss_size,
+              std::vector<uint32_t>&& new_text, uint32_t const max_rank,
+              TextLce const& text_lce, Exec const& exec = Exec())
+      : text(nullptr), text_size(v_text_size), m_sss(sss), m_sss_size(sss_size) {
+    if constexpr (t_hierarchical) {
+      build_hierarchy(std::move(new_text), exec);
+    } else {
+      build_rmq(new_text, max_rank, exec, text_lce);
     }
+  }
 
-    //Check SA and LCP array
-    /*{
-      for(volatile size_t i = 2; i < new_sa.size(); ++i) {
-        volatile size_t text_index_left = sync_set[new_sa[i-1]];
-        volatile size_t text_index_right = sync_set[new_sa[i]];
-        
-        uint64_t const max_length = std::min(text_size - text_index_left, text_size - text_index_right);
-        volatile size_t lce = lce_in_text(text_index_left, text_index_right);
-        assert((lce < max_length && text[text_index_left + lce] < text[text_index_right + lce]) 
-             || (lce == max_length && text_index_left > text_index_right));
-        assert(lce == lcp[i]);
-      }
-    }*/
-    
+  /* Reads the data structure from a file. The text and the string
+     synchronizing set are not part of it. */
+  Lce_rmq_par(serialization::reader& in, uint8_t const* const v_text, size_t const v_text_size,
+              sss_type const* const sss, size_t const sss_size)
+      : text(v_text), text_size(v_text_size), m_sss(sss), m_sss_size(sss_size) {
+    if constexpr (t_hierarchical) {
+      hierarchy_ = std::make_unique<sss_hierarchy<>>(in);
+    } else {
+      isa = in.read_array<uint32_t>();
+      lcp = in.read_array<sss_type>();
+      rmq_ds1 = std::make_unique<par_RMQ_n<sss_type>>(in, lcp);
+    }
+  }
 
-#ifdef DETAILED_TIME
-    end = std::chrono::system_clock::now();
-    std::cout << "lcp_construct_time="
-              << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << " "
-              << "lcp_construct_mem=" << (malloc_count_peak() - mem_before) << " ";
-#endif
-
-#ifdef DETAILED_TIME
-    mem_before = malloc_count_current();
-    malloc_count_reset_peak();
-    begin = std::chrono::system_clock::now();
-#endif
-    // Build RMQ data structure
-    rmq_ds1 = std::make_unique<par_RMQ_n<sss_type>>(lcp);
-
-#ifdef DETAILED_TIME
-    end = std::chrono::system_clock::now();
-    std::cout << "rmq_construct_time="
-              << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << " "
-              << "rmq_construct_mem=" << (malloc_count_peak() - mem_before) << " ";
-#endif
+  void save(serialization::writer& out) const {
+    if constexpr (t_hierarchical) {
+      hierarchy_->save(out);
+    } else {
+      out.write_array(isa);
+      out.write_array(lcp);
+      rmq_ds1->save(out);
+    }
   }
 
   uint64_t lce(uint64_t i, uint64_t j) const {
@@ -243,11 +156,19 @@ class Lce_rmq_par {
       return text_size - i;
     }
 
+    if constexpr (t_hierarchical) {
+      query_stats::count(query_stats::hierarchy);
+      uint64_t const k = hierarchy_->lce(i, j);
+      return (m_sss[i + k] - m_sss[i]) + lce_mismatch(i + k, j + k);
+    }
+
     auto min = std::min(isa[i], isa[j]) + 1;
     auto max = std::max(isa[i], isa[j]);
     if (max - min > 1024) {  // THIS 1024 HAS NOTHING TO DO WITH KTAU; DONT CHANGE IT
+      query_stats::count(query_stats::rmq);
       return lcp[rmq_ds1->rmq(min, max)];
     }
+    query_stats::count(query_stats::lcp_scan);
     auto result = lcp[min];
     for (auto i = min + 1; i <= max; ++i) {
       result = std::min(result, lcp[i]);
@@ -259,15 +180,136 @@ class Lce_rmq_par {
     return text_size;
   }
 
+  /* The parts over the reduced text. The text and the synchronizing set
+     belong to the caller. */
+  std::vector<space_component> space_breakdown() const {
+    std::vector<space_component> result;
+    if constexpr (t_hierarchical) {
+      add_space(result, "hierarchy", hierarchy_->space_breakdown());
+    } else {
+      result.push_back({"isa", isa.size() * sizeof(uint32_t)});
+      result.push_back({"lcp", lcp.size() * sizeof(sss_type)});
+      add_space(result, "rmq", rmq_ds1->space_breakdown());
+    }
+    return result;
+  }
+
  private:
   uint8_t const* const text;
   size_t text_size;
+  sss_type const* m_sss;
+  size_t m_sss_size;
 
-  std::vector<uint32_t> isa;
-  std::vector<sss_type> lcp;
+  serialization::array<uint32_t> isa;
+  serialization::array<sss_type> lcp;
   std::unique_ptr<par_RMQ_n<sss_type>> rmq_ds1;
+  std::unique_ptr<sss_hierarchy<>> hierarchy_;
+
+  template <typename Exec>
+  void build_hierarchy(std::vector<uint32_t>&& new_text, Exec const& exec) {
+    phase_profiler::scope const phase("hierarchy_construct");
+    new_text.pop_back();
+    hierarchy_ = std::make_unique<sss_hierarchy<>>(std::move(new_text), exec);
+    phase_profiler::global().set_value("hierarchy_levels", hierarchy_->num_levels());
+  }
+
+  /* text_lce(i, j) is the LCE of the text positions i and j. */
+  template <typename Exec, typename TextLce>
+  void build_rmq(std::vector<uint32_t>& new_text, uint32_t const max_rank, Exec const& exec,
+                 TextLce const& text_lce) {
+    phase_profiler::scope sa_phase("sa_construct");
+    std::vector<uint32_t> new_sa(new_text.size(), 0);
+    if constexpr (Exec::uses_openmp) {
+      libsais_int_omp(reinterpret_cast<int32_t*>(new_text.data()), reinterpret_cast<int32_t*>(new_sa.data()), new_text.size(), max_rank + 1, 0, exec.num_threads());
+    } else {
+      libsais_int(reinterpret_cast<int32_t*>(new_text.data()), reinterpret_cast<int32_t*>(new_sa.data()), new_text.size(), max_rank + 1, 0);
+    }
+
+    sa_phase.stop();
+
+    phase_profiler::scope lcp_phase("lcp_construct");
+    std::vector<uint32_t> new_isa(new_sa.size());
+    execution::parallel_for(exec, new_sa.size(), [&](size_t const i) {
+      new_isa[new_sa[i]] = i;
+    });
+
+    std::vector<sss_type> new_lcp(new_sa.size());
+    new_lcp[0] = 0;
+    new_lcp[1] = 0;
+    // text_lce may read the text from disk and throw. Then the other blocks
+    // stop, too, and the error is thrown after the parallel region.
+    execution::block_errors errors(exec.num_threads());
+    exec.for_each_block([&](int const t, int const nt) {
+      errors.run(t, [&] {
+        auto const [start_i, end_i] = execution::block_range(new_lcp.size() - 1, t, nt);
+        size_t current_lcp = 0;
+        for (size_t i = start_i; i < end_i && !errors.failed(); ++i) {
+          size_t suffix_array_pos = new_isa[i];
+          assert(suffix_array_pos != 0); //We stop loop before before isa[lce.size()-1]==0
+          if (suffix_array_pos == 1) {continue;} //We can not do lce_query with sentinel new_sa.back()
+          size_t preceding_suffix_pos = new_sa[suffix_array_pos - 1];
+          current_lcp += text_lce(m_sss[i] + current_lcp, m_sss[preceding_suffix_pos] + current_lcp);
+          new_lcp[suffix_array_pos] = current_lcp;
+
+          if (i + 1 == m_sss_size) {break;} //There is no next synchronizing position
+          uint64_t diff = m_sss[i + 1] - m_sss[i];
+          if (current_lcp < 2 * kTau + diff) {
+            current_lcp = 0;
+          } else {
+            current_lcp -= diff;
+          }
+        }
+      });
+    });
+    errors.rethrow();
+
+    //Check SA and LCP array
+    /*{
+      for(volatile size_t i = 2; i < new_sa.size(); ++i) {
+        volatile size_t text_index_left = m_sss[new_sa[i-1]];
+        volatile size_t text_index_right = m_sss[new_sa[i]];
+        
+        uint64_t const max_length = std::min(text_size - text_index_left, text_size - text_index_right);
+        volatile size_t lce = lce_in_text(text_index_left, text_index_right);
+        assert((lce < max_length && text[text_index_left + lce] < text[text_index_right + lce]) 
+             || (lce == max_length && text_index_left > text_index_right));
+        assert(lce == new_lcp[i]);
+      }
+    }*/
+    isa = serialization::array<uint32_t>(std::move(new_isa));
+    lcp = serialization::array<sss_type>(std::move(new_lcp));
+    lcp_phase.stop();
+
+    // Build RMQ data structure
+    phase_profiler::scope const rmq_phase("rmq_construct");
+    rmq_ds1 = std::make_unique<par_RMQ_n<sss_type>>(lcp, exec);
+  }
+
+  /* Strings that are cut off by the end of the text and the last string
+     get names of their own in the hierarchical mode. */
+  bool has_unique_name(sss_type const text_pos) const {
+    return text_pos + 3 * kTau > text_size || text_pos == m_sss[m_sss_size - 1];
+  }
+
+  /* Answers the lce query for the positions m_sss[i] and m_sss[j], whose
+     names differ. Then, the 3*tau long strings or their run information
+     differ. */
+  uint64_t lce_mismatch(uint64_t const i, uint64_t const j) const {
+    uint64_t const text_pos_i = m_sss[i];
+    uint64_t const text_pos_j = m_sss[j];
+    if (has_unique_name(text_pos_i) || has_unique_name(text_pos_j)) {
+      return lce_in_text(text_pos_i, text_pos_j);
+    }
+    uint64_t const lce = lce_in_text(text_pos_i, text_pos_j, 3 * kTau);
+    if (lce < 3 * kTau) {
+      return lce;
+    }
+    // Both strings start runs that end at different positions or break
+    // into different directions.
+    return std::min(m_sss[i + 1] - text_pos_i, m_sss[j + 1] - text_pos_j) + 2 * kTau - 1;
+  }
 
-  uint64_t lce_in_text(uint64_t i, uint64_t j, uint64_t up_to = std::numeric_limits<uint64_t>::max()) {
+  uint64_t lce_in_text(uint64_t i, uint64_t j, uint64_t up_to = std::numeric_limits<uint64_t>::max()) const {
     uint64_t const max_length = std::min({text_size - i, text_size - j, up_to});
     uint64_t lce_naive = 0;
     while (lce_naive < max_length) {
@@ -279,7 +321,7 @@ class Lce_rmq_par {
     return lce_naive;
   }
 
-  uint64_t lce_in_text_exact(uint64_t text_pos_i, uint64_t text_pos_j, uint64_t exact_up_to) {
+  uint64_t lce_in_text_exact(uint64_t text_pos_i, uint64_t text_pos_j, uint64_t exact_up_to) const {
     uint64_t lce = 0;
     while(lce < exact_up_to && text[text_pos_i + lce] == text[text_pos_j + lce]){
       ++lce;
@@ -287,7 +329,7 @@ class Lce_rmq_par {
     return lce;
   }
 
-  bool leq_three_tau(size_t text_pos_i, size_t text_pos_j, string_synchronizing_set_par<kTau, sss_type> const& sync_set) {
+  bool leq_three_tau(size_t text_pos_i, size_t text_pos_j, string_synchronizing_set_par<kTau, sss_type> const& sync_set) const {
     size_t const max_length = std::min({text_size - text_pos_i, text_size - text_pos_j, 3 * kTau});
     size_t text_lce = lce_in_text_exact(text_pos_i, text_pos_j, max_length);
     return (text_lce < max_length && text[text_pos_i + text_lce] < text[text_pos_j + text_lce]) 
@@ -295,7 +337,7 @@ class Lce_rmq_par {
   }
 
   
-  bool eq_three_tau(size_t text_pos_i, size_t text_pos_j, string_synchronizing_set_par<kTau, sss_type> const& sync_set) {
+  bool eq_three_tau(size_t text_pos_i, size_t text_pos_j, string_synchronizing_set_par<kTau, sss_type> const& sync_set) const {
     size_t const max_length = std::min({text_size - text_pos_i, text_size - text_pos_j, 3 * kTau});
     size_t text_lce = lce_in_text_exact(text_pos_i, text_pos_j, max_length);
     return ((text_lce == max_length) && sync_set.get_run_info(text_pos_i) == sync_set.get_run_info(text_pos_j));
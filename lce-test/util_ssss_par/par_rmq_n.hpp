@@ -4,45 +4,60 @@
 
 #include <vector>
 
+#include "../util/execution.hpp"
+#include "../util/lce_interface.hpp"
+#include "../util/serialization.hpp"
 #include "par_rmq_nlgn.hpp"
-#include <omp.h>
 
 namespace lce_test::par {
 //static constexpr uint64_t c_block_size = 32;
 template <typename key_type, u_int64_t c_block_size = 256>
 class par_RMQ_n {
-  std::vector<key_type> const& m_data;
-  std::vector<uint32_t> m_sampled_indexes;
-  std::vector<key_type> m_sampled_minimas;
+  serialization::array<key_type> const& m_data;
+  serialization::array<uint32_t> m_sampled_indexes;
+  serialization::array<key_type> m_sampled_minimas;
   par_RMQ_nlgn<key_type> m_sampled_rmq;
 
  public:
-  par_RMQ_n(std::vector<key_type> const& data) : m_data(data) {
+  template <typename Exec = execution::default_policy>
+  par_RMQ_n(serialization::array<key_type> const& data, Exec const& exec = Exec()) : m_data(data) {
     const uint64_t num_sampled_elements = (data.size() - 1) / c_block_size + 1;
-    m_sampled_indexes.resize(num_sampled_elements);
-    m_sampled_minimas.resize(num_sampled_elements);
+    std::vector<uint32_t> sampled_indexes(num_sampled_elements);
+    std::vector<key_type> sampled_minimas(num_sampled_elements);
     
-    //Get the minimal elements from the blocks.
-    #pragma omp parallel for
-    for (size_t block = 0; block < num_sampled_elements; ++block) {
+    //Get the minimal elements from the blocks, including the partial last one.
+    execution::parallel_for(exec, num_sampled_elements, [&](size_t const block) {
       uint32_t min_index = block * c_block_size;
-      for (size_t i = block * c_block_size; i < (1 + block) * c_block_size; ++i) {
+      for (size_t i = block * c_block_size; i < std::min((1 + block) * c_block_size, data.size()); ++i) {
         min_index = data[min_index] <= data[i] ? min_index : i;
       }
-      m_sampled_indexes[block] = min_index;
-      m_sampled_minimas[block] = m_data[min_index];
-    }
-    //Also get the minimum from the last block.
-    if (data.size() % c_block_size != 0) {
-      uint32_t min_index = data.size() - 1;
-      for (size_t i = data.size() - 1; i % c_block_size != 0; --i) {
-        min_index = data[min_index] <= data[i] ? min_index : i;
-      }
-      m_sampled_indexes.push_back(min_index);
-      m_sampled_minimas.push_back(m_data[min_index]);
-    }
+      sampled_indexes[block] = min_index;
+      sampled_minimas[block] = m_data[min_index];
+    });
+    m_sampled_indexes = serialization::array<uint32_t>(std::move(sampled_indexes));
+    m_sampled_minimas = serialization::array<key_type>(std::move(sampled_minimas));
     //Build an RMQ data structure for these block minimas.
-    m_sampled_rmq = par_RMQ_nlgn<key_type>(m_sampled_minimas);
+    m_sampled_rmq = par_RMQ_nlgn<key_type>(m_sampled_minimas, exec);
+  }
+
+  /* Reads the RMQ data structure over data from a file. */
+  par_RMQ_n(serialization::reader& in, serialization::array<key_type> const& data)
+      : m_data(data),
+        m_sampled_indexes(in.read_array<uint32_t>()),
+        m_sampled_minimas(in.read_array<key_type>()),
+        m_sampled_rmq(in, m_sampled_minimas) {}
+
+  void save(serialization::writer& out) const {
+    out.write_array(m_sampled_indexes);
+    out.write_array(m_sampled_minimas);
+    m_sampled_rmq.save(out);
+  }
+
+  /* The array of the values belongs to the caller and is not counted. */
+  std::vector<space_component> space_breakdown() const {
+    return {{"sampled_indexes", m_sampled_indexes.size() * sizeof(uint32_t)},
+            {"sampled_minimas", m_sampled_minimas.size() * sizeof(key_type)},
+            {"sampled_rmq", m_sampled_rmq.size_in_bytes()}};
   }
 
   uint32_t rmq(uint32_t const left, uint32_t const right) const {
@@ -1,10 +1,13 @@
 #pragma once
 
 #include <assert.h>
-#include <omp.h>
 
 #include <vector>
 
+#include "../util/execution.hpp"
+#include "../util/serialization.hpp"
+#include "../util/timeline.hpp"
+
 namespace lce_test::par {
 inline size_t log2_of_uint32(uint32_t const x) {
   assert(x != 0);
@@ -14,34 +17,61 @@ inline size_t log2_of_uint32(uint32_t const x) {
 template <typename key_type>
 class par_RMQ_nlgn {
   key_type const* m_data = nullptr;
-  std::vector<std::vector<uint32_t>> m_power_rmq;
+  std::vector<serialization::array<uint32_t>> m_power_rmq;
 
  public:
   par_RMQ_nlgn() {}
 
-  par_RMQ_nlgn(std::vector<key_type> const& data) : m_data(data.data()) {
+  template <typename Exec = execution::default_policy>
+  par_RMQ_nlgn(serialization::array<key_type> const& data, Exec const& exec = Exec()) : m_data(data.data()) {
+    timeline::span const span("rmq_levels");
     const uint32_t m_num_levels = log2_of_uint32(data.size());
     m_power_rmq.resize(m_num_levels);
+    if (m_num_levels == 0) {
+      return;
+    }
 
     //Build first level
-    m_power_rmq[0].resize(data.size() - 1);
-
-    #pragma omp parallel for
-    for (size_t i = 0; i < data.size() - 1; ++i) {
-      m_power_rmq[0][i] = m_data[i] < data[i + 1] ? i : (i + 1);
-    }
+    std::vector<uint32_t> level(data.size() - 1);
+    execution::parallel_for(exec, data.size() - 1, [&](size_t const i) {
+      level[i] = m_data[i] < data[i + 1] ? i : (i + 1);
+    });
+    m_power_rmq[0] = serialization::array<uint32_t>(std::move(level));
 
     //Build the rest
     for (size_t l = 1; l < m_num_levels; ++l) {
-      m_power_rmq[l].resize(data.size() - ((uint64_t{2} << l) - 1));
+      level.resize(data.size() - ((uint64_t{2} << l) - 1));
       uint32_t const span = (uint64_t{1} << l);
-      #pragma omp parallel for
-      for (size_t i = 0; i < m_power_rmq[l].size(); ++i) {
+      execution::parallel_for(exec, level.size(), [&](size_t const i) {
         const uint32_t l_interval_min = m_power_rmq[l - 1][i];
         const uint32_t r_interval_min = m_power_rmq[l - 1][i + span];
-        m_power_rmq[l][i] = m_data[l_interval_min] < m_data[r_interval_min] ? l_interval_min : r_interval_min;
-      }
+        level[i] = m_data[l_interval_min] < m_data[r_interval_min] ? l_interval_min : r_interval_min;
+      });
+      m_power_rmq[l] = serialization::array<uint32_t>(std::move(level));
+    }
+  }
+
+  /* Reads the levels of the RMQ data structure over data from a file. */
+  par_RMQ_nlgn(serialization::reader& in, serialization::array<key_type> const& data) : m_data(data.data()) {
+    m_power_rmq.resize(in.read<uint64_t>());
+    for (auto& level : m_power_rmq) {
+      level = in.read_array<uint32_t>();
+    }
+  }
+
+  void save(serialization::writer& out) const {
+    out.write(uint64_t{m_power_rmq.size()});
+    for (auto const& level : m_power_rmq) {
+      out.write_array(level);
+    }
+  }
+
+  size_t size_in_bytes() const {
+    size_t bytes = 0;
+    for (auto const& level : m_power_rmq) {
+      bytes += level.size() * sizeof(uint32_t);
     }
+    return bytes;
   }
 
   size_t rmq(size_t const left, size_t const right) const {
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <assert.h>
+
+#include <ips4o.hpp>
+#include <iostream>
+#include <vector>
+
+#include "../util/execution.hpp"
+#include "../util/timeline.hpp"
+
+namespace lce_test::par {
+
+template <typename sss_type>
+struct rank_tuple {
+  sss_type index;
+  uint32_t rank; //We assume the string synchronizing set hold less than 2^31 values. For tau=512 this is around 500GB text.
+
+  rank_tuple() = default;
+  rank_tuple(sss_type _index, uint32_t _rank) : index(_index), rank(_rank) {}
+
+  friend std::ostream& operator<<(std::ostream& os, rank_tuple const& rt) {
+    return os << "[ " << rt.index << ", " << rt.rank << "]";
+  }
+};  // struct rank_tuple
+
+/* Gives the sorted strings their rank. Neighbouring strings for which
+   eq(left, right) holds get the same rank. Ranks start at 1. */
+template <typename sss_type, typename Eq, typename Exec>
+std::vector<rank_tuple<sss_type>> compute_ranks(std::vector<sss_type> const& sorted_strings,
+                                                Eq const& eq, Exec const& exec) {
+  std::vector<rank_tuple<sss_type>> rank_tuples(sorted_strings.size()); // Store <sss_index, rank> tuples.
+  // We may need to adjust ranks at block borders.
+  int const nt = exec.num_threads();
+  std::vector<uint32_t> max_ranks(nt);  // Max rank in block
+  std::vector<char> all_ranks_equal(nt); // Are all ranks in the block equal?
+  std::vector<char> rank_extends_prev_block(nt); // Is first rank in block == last rank in prev block?
+
+  // First compare strings in block and adjust ranks
+  timeline::span block_span("rank_blocks");
+  exec.for_each_block([&](int const t, int const nt) {
+    auto const [start_i, end_i] = execution::block_range(rank_tuples.size(), t, nt);
+    if (start_i == end_i) {
+      // Empty blocks take over the max rank of the previous block.
+      max_ranks[t] = start_i;
+      all_ranks_equal[t] = true;
+      rank_extends_prev_block[t] = (start_i != 0);
+      return;
+    }
+
+    uint32_t cur_rank = start_i + 1;
+    rank_tuples[start_i] = {sorted_strings[start_i], cur_rank};
+
+    for (size_t i = start_i + 1; i < end_i; ++i) {
+      if(!eq(sorted_strings[i-1], sorted_strings[i])) {
+        ++cur_rank;
+      }
+      rank_tuples[i] = {sorted_strings[i], cur_rank};
+    }
+    max_ranks[t] = cur_rank;
+    all_ranks_equal[t] = (max_ranks[t] == start_i+1);
+    rank_extends_prev_block[t] = (start_i == 0) ? false : eq(sorted_strings[start_i-1], sorted_strings[start_i]);
+  });
+
+  block_span.stop();
+
+  // Now adjust ranks between blocks
+  timeline::span const fixup_span("rank_fixup");
+  exec.for_each_block([&](int const t, int const nt) {
+    auto const [start_i, end_i] = execution::block_range(rank_tuples.size(), t, nt);
+    if (start_i == end_i || !rank_extends_prev_block[t]) {
+      return;
+    }
+    int target_t = t-1;
+    while(all_ranks_equal[target_t] && rank_extends_prev_block[target_t]) {
+      --target_t;
+    }
+    uint32_t const target_rank = max_ranks[target_t];
+
+    uint32_t const rank_to_decrease = rank_tuples[start_i].rank;
+    for (size_t i = start_i; i < end_i && rank_tuples[i].rank == rank_to_decrease; ++i) {
+      rank_tuples[i].rank = target_rank;
+    }
+  });
+  return rank_tuples;
+}
+
+/* Replaces each string by its rank. The result is ordered by the
+   string index and ends with a 0 sentinel. */
+template <typename sss_type, typename Exec>
+std::vector<uint32_t> reduced_text(std::vector<rank_tuple<sss_type>>& rank_tuples, Exec const& exec) {
+  timeline::span sort_span("reduced_text_sort");
+  ips4o::sort(rank_tuples.begin(), rank_tuples.end(),
+              [](rank_tuple<sss_type> const& lhs, rank_tuple<sss_type> const& rhs) {
+                return lhs.index < rhs.index;
+              });
+  sort_span.stop();
+
+  timeline::span const text_span("reduced_text");
+  std::vector<uint32_t> new_text(rank_tuples.size() + 1, 0);
+  execution::parallel_for(exec, rank_tuples.size(), [&](size_t const i) {
+    new_text[i] = rank_tuples[i].rank;
+  });
+  new_text.back() = 0;
+  return new_text;
+}
+}  // namespace lce_test::par
+
+/******************************************************************************/
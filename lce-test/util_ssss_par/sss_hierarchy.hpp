@@ -0,0 +1,357 @@
+#pragma once
+
+#include <src/libsais.h>
+
+#include <algorithm>
+#include <compare>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <ips4o.hpp>
+
+#include "../util/execution.hpp"
+#include "../util/lce_interface.hpp"
+#include "../util/serialization.hpp"
+#include "../util/successor/index_par.hpp"
+#include "par_rmq_n.hpp"
+#include "reduced_text.hpp"
+
+namespace lce_test::par {
+
+/* Answers LCE queries on a reduced text (the names of the strings starting
+ * at the positions of a string synchronizing set) with a hierarchy of string
+ * synchronizing sets. Each level computes a string synchronizing set with
+ * t_tau over its text and names the 3 * t_tau long strings starting at its
+ * positions. These names are the text of the next level. Measured in
+ * characters of the original text, tau grows by a factor of about t_tau / 2
+ * per level. Only the last (small) level has a suffix array. */
+template <uint64_t t_tau = 16, uint64_t t_top_size = (uint64_t{1} << 16)>
+class sss_hierarchy {
+  __extension__ typedef unsigned __int128 uint128_t;
+
+  static_assert(t_tau >= 3);
+
+ public:
+  // Levels with at most t_top_size names are not reduced any further.
+  static constexpr size_t kMaxLevels = 16;
+
+  template <typename Exec = execution::default_policy>
+  sss_hierarchy(std::vector<uint32_t>&& text, Exec const& exec = Exec()) {
+    levels_.push_back(std::make_unique<level>());
+    levels_.back()->text = array_type(std::move(text));
+
+    while (levels_.size() < kMaxLevels && levels_.back()->text.size() > t_top_size) {
+      level& cur = *levels_.back();
+      cur.sync_set = array_type(fill_synchronizing_set(cur.text, exec));
+      // Stop if the next level would not be much smaller.
+      if (cur.sync_set.empty() || 2 * cur.sync_set.size() > cur.text.size()) {
+        cur.sync_set = array_type();
+        break;
+      }
+      cur.ind = std::make_unique<index_type>(cur.sync_set, exec);
+
+      auto next = std::make_unique<level>();
+      next->text = array_type(name_strings(cur, exec));
+      levels_.push_back(std::move(next));
+    }
+    build_top(exec);
+  }
+
+  /* Reads the hierarchy from a file. */
+  sss_hierarchy(serialization::reader& in) {
+    size_t const num_levels = in.read<uint64_t>();
+    for (size_t l = 0; l < num_levels; ++l) {
+      levels_.push_back(std::make_unique<level>());
+      level& cur = *levels_.back();
+      cur.text = in.read_array<uint32_t>();
+      if (l + 1 < num_levels) {
+        cur.sync_set = in.read_array<uint32_t>();
+        cur.ind = std::make_unique<index_type>(in, cur.sync_set);
+      }
+    }
+    top_isa_ = in.read_array<uint32_t>();
+    top_lcp_ = in.read_array<uint32_t>();
+    top_rmq_ = std::make_unique<par_RMQ_n<uint32_t>>(in, top_lcp_);
+  }
+
+  void save(serialization::writer& out) const {
+    out.write(uint64_t{levels_.size()});
+    for (size_t l = 0; l < levels_.size(); ++l) {
+      out.write_array(levels_[l]->text);
+      if (l + 1 < levels_.size()) {
+        out.write_array(levels_[l]->sync_set);
+        levels_[l]->ind->save(out);
+      }
+    }
+    out.write_array(top_isa_);
+    out.write_array(top_lcp_);
+    top_rmq_->save(out);
+  }
+
+  /* Answers the lce query (in names) for position a and b of the reduced text */
+  uint64_t lce(uint64_t const a, uint64_t const b) const {
+    return lce(0, a, b);
+  }
+
+  size_t num_levels() const {
+    return levels_.size();
+  }
+
+  std::vector<space_component> space_breakdown() const {
+    std::vector<space_component> result;
+    for (size_t l = 0; l < levels_.size(); ++l) {
+      std::string const name = "level" + std::to_string(l) + "/";
+      result.push_back({name + "text", levels_[l]->text.size() * sizeof(uint32_t)});
+      if (levels_[l]->ind) {
+        result.push_back({name + "sync_set", levels_[l]->sync_set.size() * sizeof(uint32_t)});
+        result.push_back({name + "successor_index", levels_[l]->ind->size_in_bytes()});
+      }
+    }
+    result.push_back({"top_isa", top_isa_.size() * sizeof(uint32_t)});
+    result.push_back({"top_lcp", top_lcp_.size() * sizeof(uint32_t)});
+    add_space(result, "top_rmq", top_rmq_->space_breakdown());
+    return result;
+  }
+
+ private:
+  using array_type = serialization::array<uint32_t>;
+  using index_type = stash::pred::index_par<array_type, uint32_t, 7>;
+
+  struct level {
+    array_type text;
+    array_type sync_set;
+    std::unique_ptr<index_type> ind;
+  };
+
+  static constexpr uint64_t kPrime = (uint64_t{1} << 61) - 1;
+  static constexpr uint64_t kBase = 296813;
+
+  std::vector<std::unique_ptr<level>> levels_;
+
+  array_type top_isa_;
+  array_type top_lcp_;
+  std::unique_ptr<par_RMQ_n<uint32_t>> top_rmq_;
+
+  uint64_t lce(size_t const l, uint64_t const a, uint64_t const b) const {
+    array_type const& text = levels_[l]->text;
+    if (a == b) {
+      return text.size() - a;
+    }
+    if (l + 1 == levels_.size()) {
+      return lce_top(a, b);
+    }
+
+    /* naive part */
+    uint64_t const max_length = std::min(3 * t_tau, text.size() - std::max(a, b));
+    uint64_t const lce_naive = lce_scan(text, a, b, max_length);
+    if (lce_naive < 3 * t_tau) {
+      return lce_naive;
+    }
+
+    /* strSync part */
+    level const& cur = *levels_[l];
+    stash::pred::result const a_suc = cur.ind->successor(a);
+    stash::pred::result const b_suc = cur.ind->successor(b);
+    if (!a_suc.exists || !b_suc.exists) {
+      return lce_naive + lce_scan(text, a + lce_naive, b + lce_naive);
+    }
+    uint64_t const a_diff = cur.sync_set[a_suc.pos] - a;
+    uint64_t const b_diff = cur.sync_set[b_suc.pos] - b;
+    if (a_diff != b_diff) {
+      // The lce is less than min(a_diff, b_diff) + 2 * t_tau.
+      return lce_naive + lce_scan(text, a + lce_naive, b + lce_naive);
+    }
+
+    // The last name is unique, so both suffixes end before the end of the next level.
+    uint64_t const k = lce(l + 1, a_suc.pos, b_suc.pos);
+    uint64_t const a_mismatch = cur.sync_set[a_suc.pos + k];
+    uint64_t const b_mismatch = cur.sync_set[b_suc.pos + k];
+    // The names at the mismatch differ, so the remaining lce is short.
+    return (a_mismatch - a) + lce_scan(text, a_mismatch, b_mismatch);
+  }
+
+  uint64_t lce_top(uint64_t const a, uint64_t const b) const {
+    auto min = std::min(top_isa_[a], top_isa_[b]) + 1;
+    auto max = std::max(top_isa_[a], top_isa_[b]);
+    if (max - min > 1024) {
+      return top_lcp_[top_rmq_->rmq(min, max)];
+    }
+    auto result = top_lcp_[min];
+    for (auto i = min + 1; i <= max; ++i) {
+      result = std::min(result, top_lcp_[i]);
+    }
+    return result;
+  }
+
+  static uint64_t lce_scan(array_type const& text, uint64_t const a, uint64_t const b,
+                           uint64_t const up_to = std::numeric_limits<uint64_t>::max()) {
+    uint64_t const max_length = std::min(up_to, text.size() - std::max(a, b));
+    uint64_t lce = 0;
+    while (lce < max_length && text[a + lce] == text[b + lce]) {
+      ++lce;
+    }
+    return lce;
+  }
+
+  static uint64_t add_mod(uint64_t const a, uint64_t const b) {
+    uint64_t const sum = a + b;
+    return (sum >= kPrime) ? sum - kPrime : sum;
+  }
+
+  static uint64_t mul_mod(uint64_t const a, uint64_t const b) {
+    uint128_t const product = uint128_t{a} * b;
+    uint64_t result = (static_cast<uint64_t>(product) & kPrime) + static_cast<uint64_t>(product >> 61);
+    result = (result & kPrime) + (result >> 61);
+    return (result >= kPrime) ? result - kPrime : result;
+  }
+
+  // Does text[i, i + t_tau) have a period of at most t_tau / 3?
+  static bool has_small_period(array_type const& text, size_t const i) {
+    for (size_t period = 1; period <= t_tau / 3; ++period) {
+      if (std::equal(text.begin() + i, text.begin() + i + t_tau - period,
+                     text.begin() + i + period)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /* Computes the string synchronizing set of the text. A position i is in
+     the set, if the minimal fingerprint of the non-periodic strings
+     text[j, j + t_tau) with j in [i, i + t_tau] is the one at i or i + t_tau.
+     Excluding periodic strings keeps the set small inside of runs. */
+  template <typename Exec>
+  static std::vector<uint32_t> fill_synchronizing_set(array_type const& text,
+                                                      Exec const& exec) {
+    if (text.size() < 3 * t_tau) {
+      return {};
+    }
+    uint64_t power = 1;
+    for (uint64_t i = 1; i < t_tau; ++i) {
+      power = mul_mod(power, kBase);
+    }
+
+    size_t const num_fingerprints = text.size() - t_tau + 1;
+    std::vector<uint64_t> fingerprints(num_fingerprints);
+    std::vector<char> periodic(num_fingerprints);
+    exec.for_each_block([&](int const t, int const nt) {
+      auto const [start_i, end_i] = execution::block_range(num_fingerprints, t, nt);
+      if (start_i == end_i) {
+        return;
+      }
+      uint64_t fp = 0;
+      for (size_t j = start_i; j < start_i + t_tau; ++j) {
+        fp = add_mod(mul_mod(fp, kBase), text[j]);
+      }
+      for (size_t j = start_i; j < end_i; ++j) {
+        if (j != start_i) {
+          uint64_t const first_char_influence = mul_mod(text[j - 1], power);
+          fp = (fp >= first_char_influence) ? fp - first_char_influence : fp + kPrime - first_char_influence;
+          fp = add_mod(mul_mod(fp, kBase), text[j + t_tau - 1]);
+        }
+        fingerprints[j] = fp;
+        periodic[j] = has_small_period(text, j);
+      }
+    });
+
+    size_t const sss_end = text.size() - 2 * t_tau + 1;
+    std::vector<std::vector<uint32_t>> sss_part(exec.num_threads());
+    exec.for_each_block([&](int const t, int const nt) {
+      auto const [start_i, end_i] = execution::block_range(sss_end, t, nt);
+      for (size_t i = start_i; i < end_i; ++i) {
+        uint64_t min = std::numeric_limits<uint64_t>::max();
+        for (size_t j = i; j <= i + t_tau; ++j) {
+          if (!periodic[j]) {
+            min = std::min(min, fingerprints[j]);
+          }
+        }
+        if ((!periodic[i] && fingerprints[i] == min) ||
+            (!periodic[i + t_tau] && fingerprints[i + t_tau] == min)) {
+          sss_part[t].push_back(i);
+        }
+      }
+    });
+
+    std::vector<uint32_t> sss;
+    for (auto& part : sss_part) {
+      sss.insert(sss.end(), part.begin(), part.end());
+    }
+    return sss;
+  }
+
+  /* Names the 3 * t_tau long strings starting at the positions of the
+     string synchronizing set together with the distance to the next
+     position. Strings cut off by the end of the text and the last string
+     get names of their own, so no lce can run over the end of a level. */
+  template <typename Exec>
+  static std::vector<uint32_t> name_strings(level const& cur, Exec const& exec) {
+    array_type const& text = cur.text;
+    array_type const& sss = cur.sync_set;
+
+    auto has_unique_name = [&](uint32_t const i) {
+      return i + 1 == sss.size() || sss[i] + 3 * t_tau > text.size();
+    };
+    auto eq = [&](uint32_t const i, uint32_t const j) {
+      return !has_unique_name(i) && !has_unique_name(j) &&
+             sss[i + 1] - sss[i] == sss[j + 1] - sss[j] &&
+             std::equal(text.begin() + sss[i], text.begin() + sss[i] + 3 * t_tau,
+                        text.begin() + sss[j]);
+    };
+
+    std::vector<uint32_t> strings_to_sort(sss.size());
+    std::iota(strings_to_sort.begin(), strings_to_sort.end(), 0);
+    auto const unique_begin = std::stable_partition(strings_to_sort.begin(), strings_to_sort.end(),
+                                                    [&](uint32_t const i) { return !has_unique_name(i); });
+    ips4o::sort(strings_to_sort.begin(), unique_begin, [&](uint32_t const i, uint32_t const j) {
+      auto const cmp = std::lexicographical_compare_three_way(
+          text.begin() + sss[i], text.begin() + sss[i] + 3 * t_tau,
+          text.begin() + sss[j], text.begin() + sss[j] + 3 * t_tau);
+      return (cmp != 0) ? (cmp < 0) : (sss[i + 1] - sss[i] < sss[j + 1] - sss[j]);
+    });
+
+    std::vector<rank_tuple<uint32_t>> rank_tuples = compute_ranks(strings_to_sort, eq, exec);
+    std::vector<uint32_t> next_text = reduced_text(rank_tuples, exec);
+    next_text.pop_back();
+    return next_text;
+  }
+
+  template <typename Exec>
+  void build_top(Exec const& exec) {
+    array_type const& text = levels_.back()->text;
+    std::vector<int32_t> top_text(text.size() + 1, 0);
+    std::copy(text.begin(), text.end(), top_text.begin());
+    int32_t const max_name = *std::max_element(top_text.begin(), top_text.end());
+    std::vector<int32_t> top_sa(top_text.size());
+    libsais_int(top_text.data(), top_sa.data(), top_text.size(), max_name + 1, 0);
+
+    std::vector<uint32_t> top_isa(top_sa.size());
+    execution::parallel_for(exec, top_sa.size(), [&](size_t const i) {
+      top_isa[top_sa[i]] = i;
+    });
+
+    // The sentinel is the first suffix, so every other suffix has a preceding one.
+    std::vector<uint32_t> top_lcp(top_sa.size());
+    top_lcp[0] = 0;
+    exec.for_each_block([&](int const t, int const nt) {
+      auto const [start_i, end_i] = execution::block_range(text.size(), t, nt);
+      uint64_t current_lcp = 0;
+      for (size_t i = start_i; i < end_i; ++i) {
+        size_t const preceding_suffix = top_sa[top_isa[i] - 1];
+        current_lcp += lce_scan(text, i + current_lcp, preceding_suffix + current_lcp);
+        top_lcp[top_isa[i]] = current_lcp;
+        if (current_lcp > 0) {
+          --current_lcp;
+        }
+      }
+    });
+    top_isa_ = array_type(std::move(top_isa));
+    top_lcp_ = array_type(std::move(top_lcp));
+    top_rmq_ = std::make_unique<par_RMQ_n<uint32_t>>(top_lcp_, exec);
+  }
+};
+}  // namespace lce_test::par
+
+/******************************************************************************/
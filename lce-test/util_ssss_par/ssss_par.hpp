@@ -1,13 +1,15 @@
 #pragma once
 
-#include <omp.h>
-
+#include <algorithm>
+#include <span>
 #include <string>
 #include <vector>
 #include <parallel_hashmap/phmap.h>
 #include <mutex>
 
-#include "../util/synchronizing_sets/ring_buffer.hpp"
+#include "../util/execution.hpp"
+#include "../util/timeline.hpp"
+#include "ring_buffer.hpp"
 #include "rk_prime.hpp"
 
 template <size_t t_tau = 1024, typename t_index = uint32_t>
@@ -47,39 +49,67 @@ class string_synchronizing_set_par {
     return m_sss[i];
   }
 
+  /* Moves the positions out of the set. Afterwards, the set is empty. */
+  std::vector<t_index> release_sss() {
+    return std::move(m_sss);
+  }
+
   string_synchronizing_set_par() = default;
-  string_synchronizing_set_par(const std::vector<uint8_t>& text) {
-    std::vector<std::vector<t_index>> sss_part(omp_get_max_threads());
+  template <typename Exec = lce_test::execution::default_policy>
+  string_synchronizing_set_par(std::span<const uint8_t> const text, Exec const& exec = Exec())
+      : string_synchronizing_set_par(text, exec, [](size_t, size_t) {}) {}
 
-#pragma omp parallel
-    {
-      const size_t sss_end = text.size() - 2 * t_tau + 1;
-      const size_t size_per_thread = (sss_end / omp_get_num_threads()) + 1;
-      const int t = omp_get_thread_num();
-      const size_t start = size_per_thread * t;
-      const size_t end = (t == omp_get_num_threads() - 1) ? sss_end : (t + 1) * size_per_thread;
-      sss_part[t] = fill_synchronizing_set(text, start, end);
-    }
+  /* Builds the set while the text is loaded. Each block first calls
+     load(from, to) for its part of the text and then computes the positions
+     that only depend on this part. The positions at the borders of the parts
+     follow when all parts are loaded. If load throws, e.g., because a read
+     failed, the constructor throws after all blocks are done (see
+     execution.hpp). */
+  template <typename Exec, typename Load>
+  string_synchronizing_set_par(std::span<const uint8_t> const text, Exec const& exec, Load const& load) {
+    std::vector<std::vector<t_index>> sss_part(exec.num_threads());
+    const size_t sss_end = text.size() - 2 * t_tau + 1;
+
+    // Position i depends on text[i, i + 2 * t_tau - 1).
+    std::vector<size_t> border(exec.num_threads());
+    lce_test::timeline::span fill_span("sss_fill");
+    exec.for_each_block([&](const int t, const int nt) {
+      const auto [start, end] = lce_test::execution::block_range(sss_end, t, nt);
+      const size_t load_end = (t + 1 == nt) ? text.size() : end;
+      load(start, load_end);
+      border[t] = std::clamp(load_end - std::min(load_end, 2 * t_tau - 1), start, end);
+      if (start < border[t]) {
+        sss_part[t] = fill_synchronizing_set(text, start, border[t]);
+      }
+    });
+    fill_span.stop();
+    lce_test::timeline::span border_span("sss_border");
+    exec.for_each_block([&](const int t, const int nt) {
+      const size_t end = lce_test::execution::block_range(sss_end, t, nt).second;
+      if (border[t] < end) {
+        std::vector<t_index> const border_part = fill_synchronizing_set(text, border[t], end);
+        sss_part[t].insert(sss_part[t].end(), border_part.begin(), border_part.end());
+      }
+    });
+    border_span.stop();
 
     //Merge SSS parts
+    lce_test::timeline::span merge_span("sss_merge");
     std::vector<size_t> write_pos{0};
     for (auto& part : sss_part) {
       write_pos.push_back(write_pos.back() + part.size());
     }
     size_t sss_size = write_pos.back();  //+1 for sentinel
     m_runs_detected = sss_size > text.size()*6 / t_tau;
+    merge_span.stop();
 
     //If the text contains long runs, the sss inflates. We the then use a algorithm which detects runs.
     if (m_runs_detected) {
-#pragma omp parallel
-      {
-        const size_t sss_end = text.size() - 2 * t_tau + 1;
-        const size_t size_per_thread = (sss_end / omp_get_num_threads()) + 1;
-        const int t = omp_get_thread_num();
-        const size_t start = size_per_thread * t;
-        const size_t end = (t == omp_get_num_threads() - 1) ? sss_end : (t + 1) * size_per_thread;
+      lce_test::timeline::span const runs_span("sss_runs");
+      exec.for_each_block([&](const int t, const int nt) {
+        const auto [start, end] = lce_test::execution::block_range(sss_end, t, nt);
         sss_part[t] = fill_synchronizing_set_runs(text, start, end);
-      }
+      });
       write_pos = {0};
       for (auto& part : sss_part) {
         write_pos.push_back(write_pos.back() + part.size());
@@ -87,22 +117,21 @@ class string_synchronizing_set_par {
       sss_size = write_pos.back() + 1;  //+1 for sentinel
     }
 
+    lce_test::timeline::span const copy_span("sss_copy");
     m_sss.resize(sss_size);
-#pragma omp parallel
-    {
-      const int t = omp_get_thread_num();
+    exec.for_each_block([&](const int t, [[maybe_unused]] const int nt) {
       std::copy(sss_part[t].begin(), sss_part[t].end(), m_sss.begin() + write_pos[t]);
-    }
+    });
     if (m_runs_detected) {
-      m_sss.back() = text.size() - 2 * t_tau + 1;  //sentinel needed for text with runs
+      m_sss.back() = sss_end;  //sentinel needed for text with runs
     }
   }
 
-  std::vector<t_index> fill_synchronizing_set(const std::vector<uint8_t>& text, const size_t from, const size_t to) const {
+  std::vector<t_index> fill_synchronizing_set(std::span<const uint8_t> const text, const size_t from, const size_t to) const {
     //calculate SSS
     std::vector<t_index> sss;
 
-    herlez::rolling_hash::rk_prime<decltype(text.cbegin()), 107> rk(text.cbegin() + from, t_tau, 296813);
+    herlez::rolling_hash::rk_prime<decltype(text.begin()), 107> rk(text.begin() + from, t_tau, 296813);
     ring_buffer<uint128_t> fingerprints(4 * t_tau);
     fingerprints.resize(from);
     fingerprints.push_back(rk.get_current_fp());
@@ -133,7 +162,7 @@ class string_synchronizing_set_par {
     return sss;
   }
 
-  std::vector<t_index> fill_synchronizing_set_runs(const std::vector<uint8_t>& text, const size_t from, const size_t to) {
+  std::vector<t_index> fill_synchronizing_set_runs(std::span<const uint8_t> const text, const size_t from, const size_t to) {
     //calculate Q
     std::vector<std::pair<t_index, t_index>> qset = calculate_q(text, from, to);
     
@@ -155,7 +184,7 @@ class string_synchronizing_set_par {
     //BEGIN
     std::vector<t_index> sss;
 
-    herlez::rolling_hash::rk_prime<decltype(text.cbegin()), 107> rk(text.cbegin() + from, t_tau, 296813);
+    herlez::rolling_hash::rk_prime<decltype(text.begin()), 107> rk(text.begin() + from, t_tau, 296813);
     ring_buffer<uint128_t> fingerprints(4 * t_tau);
     fingerprints.resize(from);
     fingerprints.push_back(rk.get_current_fp());
@@ -219,17 +248,19 @@ class string_synchronizing_set_par {
     return sss;
   }
 
-  std::vector<std::pair<t_index, t_index>> calculate_q(const std::vector<uint8_t>& text, const size_t from, const size_t to) {
+  std::vector<std::pair<t_index, t_index>> calculate_q(std::span<const uint8_t> const text, const size_t from, const size_t to) {
     std::vector<std::pair<t_index, t_index>> qset{};
     constexpr size_t small_tau = t_tau / 3;
-    herlez::rolling_hash::rk_prime<decltype(text.cbegin()), 107> rk(text.cbegin() + from, small_tau, 296813);
+    herlez::rolling_hash::rk_prime<decltype(text.begin()), 107> rk(text.begin() + from, small_tau, 296813);
 
     ring_buffer<uint128_t> fingerprints(4 * t_tau);
     fingerprints.resize(from);
     fingerprints.push_back(rk.get_current_fp());
 
+    //The last fingerprint starts at text.size() - small_tau
+    const size_t fingerprints_end = text.size() - small_tau + 1;
     for (size_t i = from; i < to + t_tau; ++i) {  //++i correct?
-      for (size_t j = fingerprints.size(); j < i + t_tau; ++j) {
+      for (size_t j = fingerprints.size(); j < std::min(i + t_tau, fingerprints_end); ++j) {
         fingerprints.push_back(rk.roll());
       }
       //find first minimum
@@ -273,14 +304,16 @@ class string_synchronizing_set_par {
           if(run_end - run_start + 1 >= 3 * t_tau - 1) {
             if(run_start==0) { continue; } //Run starts at 0, no run information needed
             if(text[run_start-1] == text[run_start+period-1]) {continue;} //Run starts at previous PE, we are not responsible
-            while (run_end < text.size() && text[run_end+1] == text[run_end - period+1]) {
+            while (run_end + 1 < text.size() && text[run_end+1] == text[run_end - period+1]) {
               ++run_end;
             }
 
             size_t const sss_pos1 = run_start - 1;
             size_t const sss_pos2 = run_end - (2*t_tau) + 2; 
             int64_t const run_info = int64_t{1} * text.size() - sss_pos2 + sss_pos1;
-            m_run_info[sss_pos1] = text[run_end + 1] > text[run_end - period + 1] ? run_info : run_info * (-1);
+            //A run that reaches the end of the text is smaller than its continuation
+            const bool larger_after_run = run_end + 1 < text.size() && text[run_end + 1] > text[run_end - period + 1];
+            m_run_info[sss_pos1] = larger_after_run ? run_info : run_info * (-1);
           }
         } else {
           i = next_min - 1;